@@ -0,0 +1,41 @@
+#include "AdiabaticIndex.hpp"
+#include <sstream>
+#include <iomanip>
+
+namespace
+{
+	bool Matches(double gamma, double exact, double tolerance = 1e-14)
+	{
+		return fabs(gamma - exact) <= tolerance*exact;
+	}
+}
+
+IndexKind ClassifyIndex(double gamma)
+{
+	if (Matches(gamma, 5.0 / 3.0))
+		return five_thirds_index;
+	if (Matches(gamma, 4.0 / 3.0))
+		return four_thirds_index;
+	return runtime_index;
+}
+
+string DescribeIndex(double gamma)
+{
+	ostringstream res;
+	res << setprecision(16) << gamma;
+	switch (ClassifyIndex(gamma))
+	{
+	case five_thirds_index:
+		res << " is 5/3, compile time powers";
+		break;
+	case four_thirds_index:
+		res << " is 4/3, compile time powers";
+		break;
+	default:
+		res << " runtime powers";
+		if (Matches(gamma, 5.0 / 3.0, 1e-4) || Matches(gamma, 4.0 / 3.0, 1e-4))
+			res << ", close to " << (Matches(gamma, 5.0 / 3.0, 1e-4) ? "5/3" : "4/3") <<
+				" but not equal to it, give it to full precision for the compile time powers";
+	}
+	return res.str();
+}
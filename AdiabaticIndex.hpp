@@ -0,0 +1,256 @@
+#ifndef ADIABATICINDEX_HPP
+#define ADIABATICINDEX_HPP 1
+
+#include <cmath>
+#include <string>
+
+using namespace std;
+
+//! \brief x^N by repeated squaring, unrolled at compile time
+template<int N> struct IntegerPower
+{
+	static double Apply(double x)
+	{
+		const double half = IntegerPower<N / 2>::Apply(x);
+		return (N % 2) ? half*half*x : half*half;
+	}
+};
+
+template<> struct IntegerPower<0>
+{
+	static double Apply(double /*x*/)
+	{
+		return 1;
+	}
+};
+
+template<> struct IntegerPower<1>
+{
+	static double Apply(double x)
+	{
+		return x;
+	}
+};
+
+//! \brief x^(1/Q), from square and cube roots where possible
+template<int Q> struct Root
+{
+	static double Apply(double x)
+	{
+		return pow(x, 1.0 / Q);
+	}
+};
+
+template<> struct Root<1>
+{
+	static double Apply(double x)
+	{
+		return x;
+	}
+};
+
+template<> struct Root<2>
+{
+	static double Apply(double x)
+	{
+		return sqrt(x);
+	}
+};
+
+template<> struct Root<3>
+{
+	static double Apply(double x)
+	{
+		return cbrt(x);
+	}
+};
+
+template<> struct Root<4>
+{
+	static double Apply(double x)
+	{
+		return sqrt(sqrt(x));
+	}
+};
+
+template<> struct Root<6>
+{
+	static double Apply(double x)
+	{
+		return sqrt(cbrt(x));
+	}
+};
+
+template<> struct Root<8>
+{
+	static double Apply(double x)
+	{
+		return sqrt(sqrt(sqrt(x)));
+	}
+};
+
+template<int A, int B> struct GreatestCommonDivisor
+{
+	enum { value = GreatestCommonDivisor<B, A % B>::value };
+};
+
+template<int A> struct GreatestCommonDivisor<A, 0>
+{
+	enum { value = A };
+};
+
+/*! \brief x^(P/Q) for a rational exponent known at compile time
+\details The exponent is reduced and split into an integer power and a root, so the only transcendental call is
+the root
+*/
+template<int P, int Q, bool Negative = (P < 0)> struct RationalPower
+{
+	static double Apply(double x)
+	{
+		enum { divisor = GreatestCommonDivisor<P, Q>::value, p = P / divisor, q = Q / divisor };
+		if (q == 1)
+			return IntegerPower<p>::Apply(x);
+		return IntegerPower<p / q>::Apply(x)*IntegerPower<p % q>::Apply(Root<q>::Apply(x));
+	}
+};
+
+template<int P, int Q> struct RationalPower<P, Q, true>
+{
+	static double Apply(double x)
+	{
+		return 1 / RationalPower<-P, Q>::Apply(x);
+	}
+};
+
+/*! \brief The powers of the adiabatic index used by the equation of state and the Riemann solver, with the
+index known only at run time
+\details Keeps the pow calls, so results are the same as before the specializations
+*/
+class RuntimeIndex
+{
+private:
+	double g_;
+
+public:
+	explicit RuntimeIndex(double gamma):g_(gamma)
+	{}
+
+	double Gamma()const
+	{
+		return g_;
+	}
+
+	//! \brief x^gamma
+	double PowGamma(double x)const
+	{
+		return pow(x, g_);
+	}
+
+	//! \brief x^-gamma
+	double PowMinusGamma(double x)const
+	{
+		return pow(x, -g_);
+	}
+
+	//! \brief x^((gamma-1)/(2gamma)), the rarefaction exponent
+	double PowRarefaction(double x)const
+	{
+		return pow(x, (g_ - 1) / (2 * g_));
+	}
+
+	//! \brief x^((1-gamma)/(2gamma))
+	double PowMinusRarefaction(double x)const
+	{
+		return pow(x, (-g_ + 1) / (2 * g_));
+	}
+
+	//! \brief x^((gamma+1)/(2gamma))
+	double PowShock(double x)const
+	{
+		return pow(x, (g_ + 1) / (2 * g_));
+	}
+
+	//! \brief x^(2gamma/(gamma-1)), the inverse of the rarefaction exponent
+	double PowTwoRarefaction(double x)const
+	{
+		return pow(x, 2 * g_ / (g_ - 1));
+	}
+
+	//! \brief x^-1.5, does not depend on the index but is kept here so that the runtime path keeps pow
+	double PowMinusThreeHalves(double x)const
+	{
+		return pow(x, -1.5);
+	}
+};
+
+/*! \brief The powers of an adiabatic index N/D known at compile time
+\details Every power reduces to multiplications, square and cube roots when the rarefaction exponent
+(N-D)/(2N) has such a root, as for 4/3. For 5/3 the fifth roots remain pow calls.
+*/
+template<int N, int D> class RationalIndex
+{
+public:
+	double Gamma()const
+	{
+		return static_cast<double>(N) / D;
+	}
+
+	double PowGamma(double x)const
+	{
+		return RationalPower<N, D>::Apply(x);
+	}
+
+	double PowMinusGamma(double x)const
+	{
+		return RationalPower<-N, D>::Apply(x);
+	}
+
+	double PowRarefaction(double x)const
+	{
+		return RationalPower<N - D, 2 * N>::Apply(x);
+	}
+
+	double PowMinusRarefaction(double x)const
+	{
+		return RationalPower<D - N, 2 * N>::Apply(x);
+	}
+
+	double PowShock(double x)const
+	{
+		return RationalPower<N + D, 2 * N>::Apply(x);
+	}
+
+	double PowTwoRarefaction(double x)const
+	{
+		return RationalPower<2 * N, N - D>::Apply(x);
+	}
+
+	double PowMinusThreeHalves(double x)const
+	{
+		return RationalPower<-3, 2>::Apply(x);
+	}
+};
+
+//! \brief Adiabatic indices with compile time specializations
+enum IndexKind
+{
+	runtime_index,
+	five_thirds_index,
+	four_thirds_index
+};
+
+/*! \brief Selects the specialization that matches an adiabatic index
+\param gamma The adiabatic index
+\return The specialization, runtime_index when none matches to round off
+*/
+IndexKind ClassifyIndex(double gamma);
+
+/*! \brief Describes the path ClassifyIndex selects, for the log
+\details Only an index equal to 5/3 or 4/3 to round off takes the compile time powers. One that is within 1e-4 of
+them but not equal, such as 1.6667 from an input file, is reported as such, it is usually a rounding mistake.
+\param gamma The adiabatic index
+\return A line describing the path
+*/
+string DescribeIndex(double gamma);
+
+#endif //ADIABATICINDEX_HPP
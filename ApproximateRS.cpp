@@ -0,0 +1,143 @@
+#include "ApproximateRS.hpp"
+#include <cmath>
+#include <algorithm>
+
+namespace
+{
+	double SoundSpeed(Primitive const& cell, double gamma)
+	{
+		return sqrt(gamma*cell.pressure / cell.density);
+	}
+
+	double GetPVRSPressure(Primitive const& left, Primitive const& right, double gamma)
+	{
+		double dbar = 0.5*(left.density + right.density);
+		double cbar = 0.5*(SoundSpeed(left, gamma) + SoundSpeed(right, gamma));
+		return 0.5*(left.pressure + right.pressure) - 0.5*(right.velocity - left.velocity)*dbar*cbar;
+	}
+
+	double GetShockFactor(Primitive const& cell, double p, double gamma)
+	{
+		double A = 2 / ((gamma + 1)*cell.density);
+		double B = (gamma - 1)*cell.pressure / (gamma + 1);
+		return sqrt(A / (p + B));
+	}
+}
+
+HLLC::HLLC(double gamma):gamma_(gamma)
+{}
+
+RSsolution HLLC::Solve(Primitive const & left, Primitive const & right) const
+{
+	double cl = SoundSpeed(left, gamma_);
+	double cr = SoundSpeed(right, gamma_);
+	double sl = std::min(left.velocity - cl, right.velocity - cr);
+	double sr = std::max(left.velocity + cl, right.velocity + cr);
+	double ml = left.density*(sl - left.velocity);
+	double mr = right.density*(sr - right.velocity);
+	RSsolution res;
+	res.velocity = (right.pressure - left.pressure + ml*left.velocity - mr*right.velocity) / (ml - mr);
+	res.pressure = std::max(0.0, left.pressure + ml*(res.velocity - left.velocity));
+	return res;
+}
+
+TwoShockRS::TwoShockRS(double gamma):gamma_(gamma)
+{}
+
+RSsolution TwoShockRS::Solve(Primitive const & left, Primitive const & right) const
+{
+	double p0 = std::max(0.0, GetPVRSPressure(left, right, gamma_));
+	double gl = GetShockFactor(left, p0, gamma_);
+	double gr = GetShockFactor(right, p0, gamma_);
+	RSsolution res;
+	res.pressure = std::max(0.0, (gl*left.pressure + gr*right.pressure - (right.velocity - left.velocity)) /
+		(gl + gr));
+	res.velocity = 0.5*(left.velocity + right.velocity) + 0.5*((res.pressure - right.pressure)*gr -
+		(res.pressure - left.pressure)*gl);
+	return res;
+}
+
+LinearizedRS::LinearizedRS(double gamma):gamma_(gamma)
+{}
+
+RSsolution LinearizedRS::Solve(Primitive const & left, Primitive const & right) const
+{
+	double dbar = 0.5*(left.density + right.density);
+	double cbar = 0.5*(SoundSpeed(left, gamma_) + SoundSpeed(right, gamma_));
+	RSsolution res;
+	res.pressure = std::max(0.0, GetPVRSPressure(left, right, gamma_));
+	res.velocity = 0.5*(left.velocity + right.velocity) - 0.5*(right.pressure - left.pressure) / (dbar*cbar);
+	return res;
+}
+
+HybridRS::HybridRS(RiemannSolver const & approximate, ExactRS const & exact, double gamma, double threshold):
+	approximate_(approximate),exact_(exact),gamma_(gamma),threshold_(threshold),approximate_count_(0),
+	exact_count_(0)
+{}
+
+bool HybridRS::IsWeak(Primitive const & left, Primitive const & right) const
+{
+	double pmin = std::min(left.pressure, right.pressure);
+	double cmin = std::min(SoundSpeed(left, gamma_), SoundSpeed(right, gamma_));
+	return std::fabs(right.pressure - left.pressure) < threshold_*pmin &&
+		std::fabs(right.velocity - left.velocity) < threshold_*cmin;
+}
+
+RSsolution HybridRS::Solve(Primitive const & left, Primitive const & right) const
+{
+	if (IsWeak(left, right))
+	{
+#pragma omp atomic
+		++approximate_count_;
+		return approximate_.Solve(left, right);
+	}
+#pragma omp atomic
+	++exact_count_;
+	return exact_.Solve(left, right);
+}
+
+void HybridRS::Solve(vector<pair<Primitive, Primitive> > const& states, vector<RSsolution>& res, size_t begin,
+	size_t end) const
+{
+	// Weak interfaces are solved in place, runs of strong ones are passed to the batched exact solver. Shocks
+	// span a few neighbouring interfaces, and working on runs keeps the solver free of scratch storage so that
+	// disjoint ranges can be solved concurrently.
+	size_t Nstrong = 0;
+	size_t i = begin;
+	while (i < end)
+	{
+		if (IsWeak(states[i].first, states[i].second))
+		{
+			res[i] = approximate_.Solve(states[i].first, states[i].second);
+			++i;
+			continue;
+		}
+		size_t run_end = i + 1;
+		while (run_end < end && !IsWeak(states[run_end].first, states[run_end].second))
+			++run_end;
+		exact_.Solve(states, res, i, run_end);
+		Nstrong += run_end - i;
+		i = run_end;
+	}
+	const size_t Nweak = (end - begin) - Nstrong;
+#pragma omp atomic
+	exact_count_ += Nstrong;
+#pragma omp atomic
+	approximate_count_ += Nweak;
+}
+
+size_t HybridRS::GetApproximateCount() const
+{
+	return approximate_count_;
+}
+
+size_t HybridRS::GetExactCount() const
+{
+	return exact_count_;
+}
+
+void HybridRS::ResetCounters()
+{
+	approximate_count_ = 0;
+	exact_count_ = 0;
+}
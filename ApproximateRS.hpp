@@ -0,0 +1,90 @@
+#ifndef APPROXIMATERS_HPP
+#define APPROXIMATERS_HPP 1
+
+#include "RiemannSolver.hpp"
+#include "ExactRS.hpp"
+
+//! \brief HLLC solver with Davis wave speed estimates
+class HLLC : public RiemannSolver
+{
+private:
+	const double gamma_;
+
+public:
+	explicit HLLC(double gamma);
+
+	using RiemannSolver::Solve;
+
+	RSsolution Solve(Primitive const& left, Primitive const& right)const;
+};
+
+//! \brief Two shock approximation (Toro's TSRS)
+class TwoShockRS : public RiemannSolver
+{
+private:
+	const double gamma_;
+
+public:
+	explicit TwoShockRS(double gamma);
+
+	using RiemannSolver::Solve;
+
+	RSsolution Solve(Primitive const& left, Primitive const& right)const;
+};
+
+//! \brief Primitive variable linearized solver (Toro's PVRS)
+class LinearizedRS : public RiemannSolver
+{
+private:
+	const double gamma_;
+
+public:
+	explicit LinearizedRS(double gamma);
+
+	using RiemannSolver::Solve;
+
+	RSsolution Solve(Primitive const& left, Primitive const& right)const;
+};
+
+/*! \brief Uses a cheap solver for weak jumps and the exact solver for strong ones
+\details An interface is weak when both the relative pressure jump and the velocity jump in units of the
+smaller sound speed are below the threshold
+*/
+class HybridRS : public RiemannSolver
+{
+private:
+	RiemannSolver const& approximate_;
+	ExactRS const& exact_;
+	const double gamma_;
+	const double threshold_;
+	mutable size_t approximate_count_;
+	mutable size_t exact_count_;
+
+	bool IsWeak(Primitive const& left, Primitive const& right)const;
+
+public:
+	/*!
+	\param approximate Solver used for weak jumps
+	\param exact Solver used for strong jumps
+	\param gamma Adiabatic index
+	\param threshold Largest jump that is still treated as weak
+	*/
+	HybridRS(RiemannSolver const& approximate, ExactRS const& exact, double gamma, double threshold);
+
+	using RiemannSolver::Solve;
+
+	RSsolution Solve(Primitive const& left, Primitive const& right)const;
+
+	void Solve(vector<pair<Primitive, Primitive> > const& states, vector<RSsolution> &res, size_t begin,
+		size_t end)const;
+
+	//! \brief Number of interfaces solved with the approximate solver
+	size_t GetApproximateCount()const;
+
+	//! \brief Number of interfaces solved with the exact solver
+	size_t GetExactCount()const;
+
+	void ResetCounters();
+};
+
+#endif //APPROXIMATERS_HPP
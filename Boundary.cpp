@@ -5,10 +5,16 @@
 Boundary::~Boundary()
 {}
 
-vector<Primitive> RigidWall::GetBoundaryValues(vector<Primitive> const & cells,
-	vector<double> const & edges, size_t index) const
+void Boundary::GetBothBoundaryValues(PrimitiveArrays const & cells, vector<double> const & edges,
+	Primitive (&left)[3], Primitive (&right)[3]) const
+{
+	GetBoundaryValues(cells, edges, 0, left);
+	GetBoundaryValues(cells, edges, edges.size() - 1, right);
+}
+
+void RigidWall::GetBoundaryValues(PrimitiveArrays const & cells, vector<double> const & edges, size_t index,
+	Primitive (&res)[3]) const
 {
-	vector<Primitive> res(3);
 	if (index == 0)
 	{
 		Primitive slope = (cells[1] - cells[0]) / (0.5*(edges[2] - edges[0]));
@@ -34,13 +40,11 @@ vector<Primitive> RigidWall::GetBoundaryValues(vector<Primitive> const & cells,
 		res[2].velocity = -res[1].velocity;
 		res[0] = cells[N-2] - slope*(0.5*(edges[N-1] - edges[N-2]));
 	}
-	return res;
 }
 
-vector<Primitive> FreeFlow::GetBoundaryValues(vector<Primitive> const & cells, vector<double> const & edges,
-	size_t index) const
+void FreeFlow::GetBoundaryValues(PrimitiveArrays const & cells, vector<double> const & edges, size_t index,
+	Primitive (&res)[3]) const
 {
-	vector<Primitive> res(3);
 	if (index == 0)
 	{
 		Primitive slope = (cells[1] - cells[0]) / (0.5*(edges[2] - edges[0]));
@@ -56,15 +60,13 @@ vector<Primitive> FreeFlow::GetBoundaryValues(vector<Primitive> const & cells, v
 		res[2] = res[1];
 		res[0] = cells[N - 2] - slope*(0.5*(edges[N - 1] - edges[N - 2]));
 	}
-	return res;
 }
 
-vector<Primitive> Periodic::GetBoundaryValues(vector<Primitive> const & cells, vector<double> const & edges, size_t index) const
+void Periodic::GetSlopes(PrimitiveArrays const & cells, vector<double> const & edges, Primitive & slope0,
+	Primitive & slopeN) const
 {
-	vector<Primitive> res(3);
 	size_t N = edges.size();
 	double L = edges[N - 1] - edges[0];
-	Primitive slope0,slopeN;
 	Primitive sr = (cells[1] - cells[0]) / (0.5*(edges[2] - edges[0]));
 	Primitive sl = (cells[0] - cells[N - 2]) / (0.5*(edges[1] - edges[N - 2] + L));
 	Primitive sc = (cells[1] - cells[N - 2]) / (0.5*(edges[2] + edges[1] - edges[0] - edges[N - 2] + L));
@@ -101,7 +103,14 @@ vector<Primitive> Periodic::GetBoundaryValues(vector<Primitive> const & cells, v
 	else
 		slopeN.velocity = min(fabs(sl.velocity), min(fabs(sr.velocity), fabs(sc.velocity))) * (sl.velocity > 0 ?
 			1 : -1);
+}
 
+void Periodic::GetBoundaryValues(PrimitiveArrays const & cells, vector<double> const & edges, size_t index,
+	Primitive (&res)[3]) const
+{
+	size_t N = edges.size();
+	Primitive slope0, slopeN;
+	GetSlopes(cells, edges, slope0, slopeN);
 	if (index == 0)
 	{
 		res[1] = cells[0] - slope0*(0.5*(edges[1] - edges[0]));
@@ -114,26 +123,47 @@ vector<Primitive> Periodic::GetBoundaryValues(vector<Primitive> const & cells, v
 		res[2] = cells[0] - slope0*(0.5*(edges[1] - edges[0]));
 		res[0] = cells[N - 2] - slopeN*(0.5*(edges[N - 1] - edges[N - 2]));
 	}
-	return res;
+}
+
+void Periodic::GetBothBoundaryValues(PrimitiveArrays const & cells, vector<double> const & edges,
+	Primitive (&left)[3], Primitive (&right)[3]) const
+{
+	size_t N = edges.size();
+	Primitive slope0, slopeN;
+	GetSlopes(cells, edges, slope0, slopeN);
+	left[1] = cells[0] - slope0*(0.5*(edges[1] - edges[0]));
+	left[0] = cells[N-2]+slopeN*(0.5*(edges[N-1] - edges[N-2]));
+	left[2] = cells[0] + slope0*(0.5*(edges[1] - edges[0]));
+	right[1] = left[0];
+	right[2] = left[1];
+	right[0] = cells[N - 2] - slopeN*(0.5*(edges[N - 1] - edges[N - 2]));
 }
 
 SeveralBoundary::SeveralBoundary(Boundary const & left, Boundary const & right):left_(left),right_(right)
 {}
 
-vector<Primitive> SeveralBoundary::GetBoundaryValues(vector<Primitive> const & cells, vector<double> const & edges, size_t index) const
+void SeveralBoundary::GetBoundaryValues(PrimitiveArrays const & cells, vector<double> const & edges, size_t index,
+	Primitive (&res)[3]) const
 {
 	if(index==0)
-		return left_.GetBoundaryValues(cells, edges, index);
+		left_.GetBoundaryValues(cells, edges, index, res);
 	else
-		return right_.GetBoundaryValues(cells, edges, index);
+		right_.GetBoundaryValues(cells, edges, index, res);
+}
+
+void SeveralBoundary::GetBothBoundaryValues(PrimitiveArrays const & cells, vector<double> const & edges,
+	Primitive (&left)[3], Primitive (&right)[3]) const
+{
+	left_.GetBoundaryValues(cells, edges, 0, left);
+	right_.GetBoundaryValues(cells, edges, edges.size() - 1, right);
 }
 
 ConstantPrimitive::ConstantPrimitive(Primitive outer):outer_(outer)
 {}
 
-vector<Primitive> ConstantPrimitive::GetBoundaryValues(vector<Primitive> const & cells, vector<double> const & edges, size_t index) const
+void ConstantPrimitive::GetBoundaryValues(PrimitiveArrays const & cells, vector<double> const & edges, size_t index,
+	Primitive (&res)[3]) const
 {
-	vector<Primitive> res(3);
 	size_t N = edges.size();
 	Primitive left, center, right;
 	if (index == 0)
@@ -193,5 +223,4 @@ vector<Primitive> ConstantPrimitive::GetBoundaryValues(vector<Primitive> const &
 		res[2] = outer_;
 		res[0] = cells[N - 2] - slope0*(0.5*(edges[N - 1] - edges[N - 2]));
 	}
-	return res;
 }
@@ -1,7 +1,7 @@
 #ifndef BOUNDARY_HPP
 #define BOUNDARY_HPP 1
 
-#include "Primitive.hpp"
+#include "StateArrays.hpp"
 #include <vector>
 
 using namespace std;
@@ -11,29 +11,51 @@ class Boundary
 public:
 	virtual ~Boundary();
 
-	virtual vector<Primitive> GetBoundaryValues(vector<Primitive> const& cells, vector<double> const&
-		edges,size_t index)const=0;
+	/*! \brief Calculates the values at one end of the domain
+	\param cells The cells
+	\param edges The edges
+	\param index Index of the edge, 0 for the left side and edges.size()-1 for the right side
+	\param res Ghost value and both faces of the first cell (left side), or both faces of the last cell and ghost value
+	(right side)
+	*/
+	virtual void GetBoundaryValues(PrimitiveArrays const& cells, vector<double> const& edges, size_t index,
+		Primitive (&res)[3])const=0;
+
+	/*! \brief Calculates the values at both ends of the domain, same layout as GetBoundaryValues
+	\param cells The cells
+	\param edges The edges
+	\param left Values at the left side
+	\param right Values at the right side
+	*/
+	virtual void GetBothBoundaryValues(PrimitiveArrays const& cells, vector<double> const& edges,
+		Primitive (&left)[3], Primitive (&right)[3])const;
 };
 
 class RigidWall : public Boundary
 {
 public:
-	vector<Primitive> GetBoundaryValues(vector<Primitive> const& cells, vector<double> const&
-		edges, size_t index)const;
+	void GetBoundaryValues(PrimitiveArrays const& cells, vector<double> const& edges, size_t index,
+		Primitive (&res)[3])const;
 };
 
 class FreeFlow : public Boundary
 {
 public:
-	vector<Primitive> GetBoundaryValues(vector<Primitive> const& cells, vector<double> const&
-		edges, size_t index)const;
+	void GetBoundaryValues(PrimitiveArrays const& cells, vector<double> const& edges, size_t index,
+		Primitive (&res)[3])const;
 };
 
 class Periodic : public Boundary
 {
+private:
+	void GetSlopes(PrimitiveArrays const& cells, vector<double> const& edges, Primitive &slope0,
+		Primitive &slopeN)const;
 public:
-	vector<Primitive> GetBoundaryValues(vector<Primitive> const& cells, vector<double> const&
-		edges, size_t index)const;
+	void GetBoundaryValues(PrimitiveArrays const& cells, vector<double> const& edges, size_t index,
+		Primitive (&res)[3])const;
+
+	void GetBothBoundaryValues(PrimitiveArrays const& cells, vector<double> const& edges,
+		Primitive (&left)[3], Primitive (&right)[3])const;
 };
 
 class ConstantPrimitive : public Boundary
@@ -43,8 +65,8 @@ private:
 public:
 	ConstantPrimitive(Primitive outer);
 
-	vector<Primitive> GetBoundaryValues(vector<Primitive> const& cells, vector<double> const&
-		edges, size_t index)const;
+	void GetBoundaryValues(PrimitiveArrays const& cells, vector<double> const& edges, size_t index,
+		Primitive (&res)[3])const;
 };
 
 class SeveralBoundary : public Boundary
@@ -55,8 +77,10 @@ private:
 public:
 	SeveralBoundary(Boundary const& left, Boundary const& right);
 
-	vector<Primitive> GetBoundaryValues(vector<Primitive> const& cells, vector<double> const&
-		edges, size_t index)const;
+	void GetBoundaryValues(PrimitiveArrays const& cells, vector<double> const& edges, size_t index,
+		Primitive (&res)[3])const;
 
+	void GetBothBoundaryValues(PrimitiveArrays const& cells, vector<double> const& edges,
+		Primitive (&left)[3], Primitive (&right)[3])const;
 };
 #endif //BOUNDARY_HPP
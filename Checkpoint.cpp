@@ -0,0 +1,193 @@
+#include "Checkpoint.hpp"
+#include "MappedFile.hpp"
+#include "universal_error.hpp"
+#include <cstdio>
+#include <cstring>
+#include <stdint.h>
+#if defined(__unix__) || defined(__APPLE__)
+#define CHECKPOINT_POSIX 1
+#include <unistd.h>
+#endif
+
+namespace
+{
+	const char magic[8] = { 'H', 'D', 'S', 'I', 'M', 'C', 'K', '1' };
+
+	// Written as is and checked on reading, a machine with another byte order reads it differently
+	const uint64_t byte_order = 0x0102030405060708ULL;
+
+	/* The fixed part of the file, every field is eight bytes so there is no padding. It is followed by the
+	arrays in the order of Checkpoint, each an array of doubles, and by the magic again to catch truncation. */
+	struct Header
+	{
+		char magic[8];
+		uint64_t byte_order;
+		uint64_t cells;
+		uint64_t interfaces;
+		uint64_t source;
+		uint64_t user;
+		uint64_t cycle;
+		uint64_t next_dt_valid;
+		uint64_t trimmed_cells;
+		uint64_t cell_updates;
+		uint64_t updates_avoided;
+		double time;
+		double next_dt;
+		double outflow[3];
+	};
+
+	// Number of doubles after the header
+	size_t payload_size(Header const& header)
+	{
+		return static_cast<size_t>(8 * header.cells + 1 + 2 * header.interfaces + header.source + header.user);
+	}
+
+	UniversalError file_error(string const& message, string const& fname)
+	{
+		UniversalError eo(message);
+		eo.Append2ErrorMessage(" " + fname);
+		return eo;
+	}
+
+	void write_array(FILE *f, double const* data, size_t n, string const& fname)
+	{
+		if (n > 0 && fwrite(data, sizeof(double), n, f) != n)
+		{
+			fclose(f);
+			throw file_error("Could not write checkpoint", fname);
+		}
+	}
+
+	void write_array(FILE *f, vector<double> const& data, string const& fname)
+	{
+		write_array(f, data.empty() ? 0 : &data[0], data.size(), fname);
+	}
+
+	// Copies the next n doubles of the file, the file is aligned to eight bytes so memcpy is a plain copy
+	void read_array(char const* &position, size_t n, vector<double> &res)
+	{
+		res.resize(n);
+		if (n > 0)
+			memcpy(&res[0], position, n * sizeof(double));
+		position += n * sizeof(double);
+	}
+}
+
+Checkpoint::Checkpoint():cells(),extensives(),edges(),time(0),cycle(0),interfaces(),next_dt(0),next_dt_valid(false),
+	outflow(),trimmed_cells(0),cell_updates(0),updates_avoided(0),source(),user()
+{}
+
+void write_checkpoint(Checkpoint const& checkpoint, string const& fname)
+{
+	const size_t N = checkpoint.cells.size();
+	if (checkpoint.extensives.size() != N || checkpoint.edges.size() != N + 1)
+		throw UniversalError("Checkpoint cells, extensives and edges do not match");
+	Header header;
+	memcpy(header.magic, magic, sizeof(magic));
+	header.byte_order = byte_order;
+	header.cells = N;
+	header.interfaces = checkpoint.interfaces.size();
+	header.source = checkpoint.source.size();
+	header.user = checkpoint.user.size();
+	header.cycle = checkpoint.cycle;
+	header.next_dt_valid = checkpoint.next_dt_valid ? 1 : 0;
+	header.trimmed_cells = checkpoint.trimmed_cells;
+	header.cell_updates = checkpoint.cell_updates;
+	header.updates_avoided = checkpoint.updates_avoided;
+	header.time = checkpoint.time;
+	header.next_dt = checkpoint.next_dt;
+	header.outflow[0] = checkpoint.outflow.mass;
+	header.outflow[1] = checkpoint.outflow.momentum;
+	header.outflow[2] = checkpoint.outflow.energy;
+
+	const string temp = fname + ".tmp";
+	FILE *f = fopen(temp.c_str(), "wb");
+	if (!f)
+		throw file_error("Could not create checkpoint", temp);
+	if (fwrite(&header, sizeof(header), 1, f) != 1)
+	{
+		fclose(f);
+		throw file_error("Could not write checkpoint", temp);
+	}
+	write_array(f, checkpoint.cells.density, temp);
+	write_array(f, checkpoint.cells.pressure, temp);
+	write_array(f, checkpoint.cells.velocity, temp);
+	write_array(f, checkpoint.cells.entropy, temp);
+	write_array(f, checkpoint.extensives.mass, temp);
+	write_array(f, checkpoint.extensives.momentum, temp);
+	write_array(f, checkpoint.extensives.energy, temp);
+	write_array(f, checkpoint.edges, temp);
+	// The solutions are stored as two arrays so that the layout does not depend on the struct
+	vector<double> values(checkpoint.interfaces.size());
+	for (size_t i = 0; i < values.size(); ++i)
+		values[i] = checkpoint.interfaces[i].velocity;
+	write_array(f, values, temp);
+	for (size_t i = 0; i < values.size(); ++i)
+		values[i] = checkpoint.interfaces[i].pressure;
+	write_array(f, values, temp);
+	write_array(f, checkpoint.source, temp);
+	write_array(f, checkpoint.user, temp);
+	bool good = fwrite(magic, sizeof(magic), 1, f) == 1 && fflush(f) == 0;
+#ifdef CHECKPOINT_POSIX
+	good = good && fsync(fileno(f)) == 0;
+#endif
+	good = fclose(f) == 0 && good;
+	if (!good)
+		throw file_error("Could not write checkpoint", temp);
+#ifndef CHECKPOINT_POSIX
+	// Elsewhere rename does not replace an existing file
+	remove(fname.c_str());
+#endif
+	if (rename(temp.c_str(), fname.c_str()) != 0)
+		throw file_error("Could not rename checkpoint to", fname);
+}
+
+void read_checkpoint(string const& fname, Checkpoint &res)
+{
+	const MappedFile contents(fname, true);
+	Header header;
+	if (contents.size() < sizeof(header))
+		throw file_error("Truncated checkpoint", fname);
+	memcpy(&header, contents.data(), sizeof(header));
+	if (memcmp(header.magic, magic, sizeof(magic)) != 0)
+		throw file_error("Not a checkpoint", fname);
+	if (header.byte_order != byte_order)
+		throw file_error("Checkpoint has a different byte order", fname);
+	if (contents.size() != sizeof(header) + payload_size(header) * sizeof(double) + sizeof(magic) ||
+		memcmp(contents.data() + contents.size() - sizeof(magic), magic, sizeof(magic)) != 0)
+		throw file_error("Truncated checkpoint", fname);
+
+	const size_t N = static_cast<size_t>(header.cells);
+	const size_t M = static_cast<size_t>(header.interfaces);
+	char const* position = contents.data() + sizeof(header);
+	read_array(position, N, res.cells.density);
+	read_array(position, N, res.cells.pressure);
+	read_array(position, N, res.cells.velocity);
+	read_array(position, N, res.cells.entropy);
+	read_array(position, N, res.extensives.mass);
+	read_array(position, N, res.extensives.momentum);
+	read_array(position, N, res.extensives.energy);
+	read_array(position, N + 1, res.edges);
+	vector<double> velocity;
+	vector<double> pressure;
+	read_array(position, M, velocity);
+	read_array(position, M, pressure);
+	res.interfaces.resize(M);
+	for (size_t i = 0; i < M; ++i)
+	{
+		res.interfaces[i].velocity = velocity[i];
+		res.interfaces[i].pressure = pressure[i];
+	}
+	read_array(position, static_cast<size_t>(header.source), res.source);
+	read_array(position, static_cast<size_t>(header.user), res.user);
+	res.time = header.time;
+	res.cycle = static_cast<size_t>(header.cycle);
+	res.next_dt = header.next_dt;
+	res.next_dt_valid = header.next_dt_valid != 0;
+	res.outflow.mass = header.outflow[0];
+	res.outflow.momentum = header.outflow[1];
+	res.outflow.energy = header.outflow[2];
+	res.trimmed_cells = static_cast<size_t>(header.trimmed_cells);
+	res.cell_updates = static_cast<size_t>(header.cell_updates);
+	res.updates_avoided = static_cast<size_t>(header.updates_avoided);
+}
@@ -0,0 +1,57 @@
+#ifndef CHECKPOINT_HPP
+#define CHECKPOINT_HPP 1
+
+#include "StateArrays.hpp"
+#include "RiemannSolver.hpp"
+#include <vector>
+#include <string>
+
+using namespace std;
+
+/*! \brief Everything a simulation needs to continue bit for bit from where it stopped
+\details Filled by hdsim::GetCheckpoint and given back to hdsim::Restart. A snapshot only holds the primitives
+without entropy, while the conserved extensives, interface solutions and counters are needed to repeat the
+following steps exactly.
+*/
+class Checkpoint
+{
+public:
+	PrimitiveArrays cells;
+	ExtensiveArrays extensives;
+	vector<double> edges;
+	double time;
+	size_t cycle;
+	//! \brief Solutions of the last step, may be empty
+	vector<RSsolution> interfaces;
+	//! \brief Time step found by the fused engine at the end of the last step
+	double next_dt;
+	bool next_dt_valid;
+	Extensive outflow;
+	size_t trimmed_cells;
+	size_t cell_updates;
+	size_t updates_avoided;
+	//! \brief State of the source term, see SourceTerm::GetState
+	vector<double> source;
+	//! \brief Values of the caller that are restored with the simulation, such as its output schedule
+	vector<double> user;
+
+	Checkpoint();
+};
+
+/*! \brief Writes a checkpoint to a raw binary file, replacing it atomically
+\details The data is written to fname.tmp, synced to disk and renamed to fname, so a crash leaves either the
+old or the new checkpoint and never a partial one
+\param checkpoint The checkpoint
+\param fname The name of the file
+*/
+void write_checkpoint(Checkpoint const& checkpoint, string const& fname);
+
+/*! \brief Reads a checkpoint written by write_checkpoint
+\details The file is memory mapped and read in one sequential pass. Throws a UniversalError if it is
+truncated or was written on a machine with a different byte order.
+\param fname The name of the file
+\param res The checkpoint, its storage is reused
+*/
+void read_checkpoint(string const& fname, Checkpoint &res);
+
+#endif //CHECKPOINT_HPP
@@ -0,0 +1,294 @@
+#include "DomainDecomposition.hpp"
+#include "universal_error.hpp"
+
+namespace
+{
+#ifdef HDSIM_MPI
+	// Layout of a halo message: two cells followed by two edges
+	void PackCell(PrimitiveArrays const& cells, size_t index, double *buffer)
+	{
+		buffer[0] = cells.density[index];
+		buffer[1] = cells.pressure[index];
+		buffer[2] = cells.velocity[index];
+		buffer[3] = cells.entropy[index];
+	}
+#endif
+
+	void UnpackCell(double const* buffer, PrimitiveArrays &cells, size_t index)
+	{
+		cells.density[index] = buffer[0];
+		cells.pressure[index] = buffer[1];
+		cells.velocity[index] = buffer[2];
+		cells.entropy[index] = buffer[3];
+	}
+}
+
+DomainDecomposition::DomainDecomposition(size_t global_cells):
+#ifdef HDSIM_MPI
+	comm_(MPI_COMM_WORLD),
+#endif
+	rank_(0),size_(1),global_cells_(global_cells)
+{
+#ifdef HDSIM_MPI
+	MPI_Comm_rank(comm_, &rank_);
+	MPI_Comm_size(comm_, &size_);
+#endif
+	CheckSize();
+}
+
+#ifdef HDSIM_MPI
+DomainDecomposition::DomainDecomposition(MPI_Comm comm, size_t global_cells):comm_(comm),rank_(0),size_(1),
+	global_cells_(global_cells)
+{
+	MPI_Comm_rank(comm_, &rank_);
+	MPI_Comm_size(comm_, &size_);
+	CheckSize();
+}
+#endif
+
+void DomainDecomposition::CheckSize() const
+{
+	// The reconstruction at a cut needs two cells on each side
+	if (global_cells_ < 2 * static_cast<size_t>(size_))
+	{
+		UniversalError eo("Too few cells for the number of processes");
+		eo.AddEntry("Cells", static_cast<double>(global_cells_));
+		eo.AddEntry("Processes", static_cast<double>(size_));
+		throw eo;
+	}
+}
+
+int DomainDecomposition::GetRank() const
+{
+	return rank_;
+}
+
+int DomainDecomposition::GetSize() const
+{
+	return size_;
+}
+
+size_t DomainDecomposition::GetGlobalCells() const
+{
+	return global_cells_;
+}
+
+size_t DomainDecomposition::GetBegin(int rank) const
+{
+	return (global_cells_*static_cast<size_t>(rank)) / static_cast<size_t>(size_);
+}
+
+size_t DomainDecomposition::GetEnd(int rank) const
+{
+	return GetBegin(rank + 1);
+}
+
+bool DomainDecomposition::IsFirst() const
+{
+	return rank_ == 0;
+}
+
+bool DomainDecomposition::IsLast() const
+{
+	return rank_ == size_ - 1;
+}
+
+vector<double> DomainDecomposition::LocalEdges(vector<double> const & global) const
+{
+	return vector<double>(global.begin() + static_cast<long>(GetBegin(rank_)),
+		global.begin() + static_cast<long>(GetEnd(rank_) + 1));
+}
+
+void DomainDecomposition::ExchangeHalo(PrimitiveArrays const & cells, vector<double> const & edges,
+	double (&left)[10], double (&right)[10]) const
+{
+#ifdef HDSIM_MPI
+	const size_t N = cells.size();
+	double to_left[10];
+	double to_right[10];
+	PackCell(cells, 0, to_left);
+	PackCell(cells, 1, to_left + 4);
+	to_left[8] = edges[1];
+	to_left[9] = edges[2];
+	PackCell(cells, N - 2, to_right);
+	PackCell(cells, N - 1, to_right + 4);
+	to_right[8] = edges[N - 2];
+	to_right[9] = edges[N - 1];
+	const int left_rank = IsFirst() ? MPI_PROC_NULL : rank_ - 1;
+	const int right_rank = IsLast() ? MPI_PROC_NULL : rank_ + 1;
+	MPI_Sendrecv(to_right, 10, MPI_DOUBLE, right_rank, 0, left, 10, MPI_DOUBLE, left_rank, 0, comm_,
+		MPI_STATUS_IGNORE);
+	MPI_Sendrecv(to_left, 10, MPI_DOUBLE, left_rank, 1, right, 10, MPI_DOUBLE, right_rank, 1, comm_,
+		MPI_STATUS_IGNORE);
+#else
+	(void)cells;
+	(void)edges;
+	(void)left;
+	(void)right;
+#endif
+}
+
+void DomainDecomposition::MinAll(double * values, size_t n) const
+{
+#ifdef HDSIM_MPI
+	if (size_ > 1)
+		MPI_Allreduce(MPI_IN_PLACE, values, static_cast<int>(n), MPI_DOUBLE, MPI_MIN, comm_);
+#else
+	(void)values;
+	(void)n;
+#endif
+}
+
+double DomainDecomposition::Broadcast(double value) const
+{
+#ifdef HDSIM_MPI
+	if (size_ > 1)
+		MPI_Bcast(&value, 1, MPI_DOUBLE, 0, comm_);
+#endif
+	return value;
+}
+
+double DomainDecomposition::Sum(double value) const
+{
+#ifdef HDSIM_MPI
+	if (size_ > 1)
+		MPI_Allreduce(MPI_IN_PLACE, &value, 1, MPI_DOUBLE, MPI_SUM, comm_);
+#endif
+	return value;
+}
+
+void DomainDecomposition::ReceiveFromLeft(double * values, size_t n) const
+{
+#ifdef HDSIM_MPI
+	if (!IsFirst())
+		MPI_Recv(values, static_cast<int>(n), MPI_DOUBLE, rank_ - 1, 2, comm_, MPI_STATUS_IGNORE);
+#else
+	(void)values;
+	(void)n;
+#endif
+}
+
+void DomainDecomposition::SendToRight(double const* values, size_t n) const
+{
+#ifdef HDSIM_MPI
+	if (!IsLast())
+		MPI_Send(const_cast<double*>(values), static_cast<int>(n), MPI_DOUBLE, rank_ + 1, 2, comm_);
+#else
+	(void)values;
+	(void)n;
+#endif
+}
+
+void DomainDecomposition::Gather(PrimitiveArrays const & cells, vector<double> const & edges,
+	PrimitiveArrays & global_cells, vector<double> & global_edges) const
+{
+#ifdef HDSIM_MPI
+	if (size_ > 1)
+	{
+		vector<int> cell_counts(static_cast<size_t>(size_));
+		vector<int> edge_counts(static_cast<size_t>(size_));
+		vector<int> offsets(static_cast<size_t>(size_));
+		for (int r = 0; r < size_; ++r)
+		{
+			const size_t i = static_cast<size_t>(r);
+			offsets[i] = static_cast<int>(GetBegin(r));
+			cell_counts[i] = static_cast<int>(GetEnd(r) - GetBegin(r));
+			// The edge at a cut is sent by the process on its right
+			edge_counts[i] = cell_counts[i] + ((r == size_ - 1) ? 1 : 0);
+		}
+		if (IsFirst())
+		{
+			global_cells.resize(global_cells_);
+			global_edges.resize(global_cells_ + 1);
+		}
+		const int n = cell_counts[static_cast<size_t>(rank_)];
+		vector<double> const* local[4] = { &cells.density, &cells.pressure, &cells.velocity, &cells.entropy };
+		vector<double> *global[4] = { &global_cells.density, &global_cells.pressure, &global_cells.velocity,
+			&global_cells.entropy };
+		for (size_t k = 0; k < 4; ++k)
+			MPI_Gatherv(const_cast<double*>(&(*local[k])[0]), n, MPI_DOUBLE, IsFirst() ? &(*global[k])[0] : 0,
+				&cell_counts[0], &offsets[0], MPI_DOUBLE, 0, comm_);
+		MPI_Gatherv(const_cast<double*>(&edges[0]), edge_counts[static_cast<size_t>(rank_)], MPI_DOUBLE,
+			IsFirst() ? &global_edges[0] : 0, &edge_counts[0], &offsets[0], MPI_DOUBLE, 0, comm_);
+		return;
+	}
+#endif
+	global_cells = cells;
+	global_edges = edges;
+}
+
+DomainBoundary::DomainBoundary(DomainDecomposition const & domain, Boundary const & physical):domain_(domain),
+	physical_(physical),limiter_(physical),window_cells_(),window_edges_(5)
+{
+	window_cells_.resize(4);
+}
+
+void DomainBoundary::GetCutValues(PrimitiveArrays const & cells, vector<double> const & edges,
+	double const (&ghost)[10], bool left_side, Primitive (&res)[3]) const
+{
+	// Two ghost cells and two local cells in the order they have in the whole mesh
+	const size_t N = edges.size();
+	if (left_side)
+	{
+		UnpackCell(ghost, window_cells_, 0);
+		UnpackCell(ghost + 4, window_cells_, 1);
+		window_cells_.Set(2, cells[0]);
+		window_cells_.Set(3, cells[1]);
+		window_edges_[0] = ghost[8];
+		window_edges_[1] = ghost[9];
+		window_edges_[2] = edges[0];
+		window_edges_[3] = edges[1];
+		window_edges_[4] = edges[2];
+		Primitive dummy;
+		limiter_.GetCellFaces(window_cells_, window_edges_, 1, dummy, res[0]);
+		limiter_.GetCellFaces(window_cells_, window_edges_, 2, res[1], res[2]);
+	}
+	else
+	{
+		window_cells_.Set(0, cells[N - 3]);
+		window_cells_.Set(1, cells[N - 2]);
+		UnpackCell(ghost, window_cells_, 2);
+		UnpackCell(ghost + 4, window_cells_, 3);
+		window_edges_[0] = edges[N - 3];
+		window_edges_[1] = edges[N - 2];
+		window_edges_[2] = edges[N - 1];
+		window_edges_[3] = ghost[8];
+		window_edges_[4] = ghost[9];
+		Primitive dummy;
+		limiter_.GetCellFaces(window_cells_, window_edges_, 1, res[0], res[1]);
+		limiter_.GetCellFaces(window_cells_, window_edges_, 2, res[2], dummy);
+	}
+}
+
+void DomainBoundary::GetBoundaryValues(PrimitiveArrays const & cells, vector<double> const & edges, size_t index,
+	Primitive (&res)[3]) const
+{
+	// The halo exchange is collective, so both sides are always computed
+	Primitive left[3], right[3];
+	GetBothBoundaryValues(cells, edges, left, right);
+	Primitive const* side = (index == 0) ? left : right;
+	res[0] = side[0];
+	res[1] = side[1];
+	res[2] = side[2];
+}
+
+void DomainBoundary::GetBothBoundaryValues(PrimitiveArrays const & cells, vector<double> const & edges,
+	Primitive (&left)[3], Primitive (&right)[3]) const
+{
+	if (domain_.IsFirst() && domain_.IsLast())
+	{
+		physical_.GetBothBoundaryValues(cells, edges, left, right);
+		return;
+	}
+	double left_ghost[10];
+	double right_ghost[10];
+	domain_.ExchangeHalo(cells, edges, left_ghost, right_ghost);
+	if (domain_.IsFirst())
+		physical_.GetBoundaryValues(cells, edges, 0, left);
+	else
+		GetCutValues(cells, edges, left_ghost, true, left);
+	if (domain_.IsLast())
+		physical_.GetBoundaryValues(cells, edges, edges.size() - 1, right);
+	else
+		GetCutValues(cells, edges, right_ghost, false, right);
+}
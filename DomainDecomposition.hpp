@@ -0,0 +1,149 @@
+#ifndef DOMAINDECOMPOSITION_HPP
+#define DOMAINDECOMPOSITION_HPP 1
+
+#include "Boundary.hpp"
+#include "MinMod.hpp"
+#include <vector>
+#ifdef HDSIM_MPI
+#include <mpi.h>
+#endif
+
+using namespace std;
+
+/*! \brief Splits the cells of the mesh into contiguous sub domains, one per process
+\details Process r owns the global cells [GetBegin(r),GetEnd(r)) and the edges that bound them, so the edge at a
+cut is held by both neighbours. Without HDSIM_MPI there is a single process that owns the whole mesh.
+*/
+class DomainDecomposition
+{
+private:
+#ifdef HDSIM_MPI
+	MPI_Comm comm_;
+#endif
+	int rank_;
+	int size_;
+	size_t global_cells_;
+
+	void CheckSize()const;
+
+public:
+	/*! \brief Partitions the mesh over all processes
+	\param global_cells Number of cells in the whole mesh, at least two per process
+	*/
+	explicit DomainDecomposition(size_t global_cells);
+
+#ifdef HDSIM_MPI
+	/*! \brief Partitions the mesh over the processes of a communicator
+	\param comm The communicator
+	\param global_cells Number of cells in the whole mesh, at least two per process
+	*/
+	DomainDecomposition(MPI_Comm comm, size_t global_cells);
+#endif
+
+	int GetRank()const;
+
+	int GetSize()const;
+
+	size_t GetGlobalCells()const;
+
+	//! \brief Global index of the first cell of a process
+	size_t GetBegin(int rank)const;
+
+	//! \brief One past the global index of the last cell of a process
+	size_t GetEnd(int rank)const;
+
+	//! \brief Is the left end of this sub domain the left end of the mesh
+	bool IsFirst()const;
+
+	//! \brief Is the right end of this sub domain the right end of the mesh
+	bool IsLast()const;
+
+	//! \brief The local part of a vector with one entry per global cell
+	template<class T> vector<T> LocalCells(vector<T> const& global)const
+	{
+		return vector<T>(global.begin() + static_cast<long>(GetBegin(rank_)),
+			global.begin() + static_cast<long>(GetEnd(rank_)));
+	}
+
+	//! \brief The local part of a vector with one entry per global edge
+	vector<double> LocalEdges(vector<double> const& global)const;
+
+	/*! \brief Exchanges the two outermost cells and their inner edges with the neighbouring processes
+	\param cells The local cells
+	\param edges The local edges
+	\param left Receives the two last cells and edges of the left neighbour, untouched at the left end of the mesh
+	\param right Receives the two first cells and edges of the right neighbour, untouched at the right end of the
+	mesh
+	*/
+	void ExchangeHalo(PrimitiveArrays const& cells, vector<double> const& edges, double (&left)[10],
+		double (&right)[10])const;
+
+	/*! \brief Replaces each value with its minimum over all processes
+	\param values The values
+	\param n Number of values
+	*/
+	void MinAll(double *values, size_t n)const;
+
+	//! \brief The value of the first process
+	double Broadcast(double value)const;
+
+	//! \brief Sum of a value over all processes
+	double Sum(double value)const;
+
+	/*! \brief Waits for the values sent by the process on the left with SendToRight
+	\details Together they pass a running result along the processes in order of rank, so that it is computed in
+	the same order as in the whole mesh
+	\param values Receives the values, untouched on the first process
+	\param n Number of values
+	*/
+	void ReceiveFromLeft(double *values, size_t n)const;
+
+	/*! \brief Sends values to the process on the right, does nothing on the last process
+	\param values The values
+	\param n Number of values
+	*/
+	void SendToRight(double const* values, size_t n)const;
+
+	/*! \brief Collects the whole mesh on the first process
+	\param cells The local cells
+	\param edges The local edges
+	\param global_cells All the cells, only set on the first process
+	\param global_edges All the edges, only set on the first process
+	*/
+	void Gather(PrimitiveArrays const& cells, vector<double> const& edges, PrimitiveArrays &global_cells,
+		vector<double> &global_edges)const;
+};
+
+/*! \brief Boundary of a sub domain
+\details Uses the physical boundary at the ends of the mesh and the two ghost cells on each side received from the
+neighbouring processes at internal cuts. The faces at a cut are reconstructed from the same stencil as in the
+whole mesh, so the results do not depend on the number of processes. The physical boundary may only read the cells
+next to the end it handles.
+*/
+class DomainBoundary : public Boundary
+{
+private:
+	DomainDecomposition const& domain_;
+	Boundary const& physical_;
+	MinMod limiter_;
+	mutable PrimitiveArrays window_cells_;
+	mutable vector<double> window_edges_;
+
+	void GetCutValues(PrimitiveArrays const& cells, vector<double> const& edges, double const (&ghost)[10],
+		bool left_side, Primitive (&res)[3])const;
+
+public:
+	/*!
+	\param domain The decomposition
+	\param physical Boundary conditions at the ends of the mesh
+	*/
+	DomainBoundary(DomainDecomposition const& domain, Boundary const& physical);
+
+	void GetBoundaryValues(PrimitiveArrays const& cells, vector<double> const& edges, size_t index,
+		Primitive (&res)[3])const;
+
+	void GetBothBoundaryValues(PrimitiveArrays const& cells, vector<double> const& edges,
+		Primitive (&left)[3], Primitive (&right)[3])const;
+};
+
+#endif //DOMAINDECOMPOSITION_HPP
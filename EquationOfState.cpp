@@ -0,0 +1,34 @@
+#include "EquationOfState.hpp"
+
+void EquationOfState::dp2e(double const* d, double const* p, double *e, size_t n) const
+{
+	for (size_t i = 0; i < n; ++i)
+		e[i] = dp2e(d[i], p[i]);
+}
+
+void EquationOfState::de2p(double const* d, double const* e, double *p, size_t n) const
+{
+	for (size_t i = 0; i < n; ++i)
+		p[i] = de2p(d[i], e[i]);
+}
+
+void EquationOfState::dp2c(double const* d, double const* p, double *c, size_t n) const
+{
+	for (size_t i = 0; i < n; ++i)
+		c[i] = dp2c(d[i], p[i]);
+}
+
+void EquationOfState::dp2s(double const* d, double const* p, double *s, size_t n) const
+{
+	for (size_t i = 0; i < n; ++i)
+		s[i] = dp2s(d[i], p[i]);
+}
+
+void EquationOfState::sd2p(double const* s, double const* d, double *p, size_t n) const
+{
+	for (size_t i = 0; i < n; ++i)
+		p[i] = sd2p(s[i], d[i]);
+}
+
+EquationOfState::~EquationOfState()
+{}
@@ -0,0 +1,51 @@
+#ifndef EQUATIONOFSTATE_HPP
+#define EQUATIONOFSTATE_HPP 1
+
+#include <cstddef>
+
+using namespace std;
+
+/*! \brief Interface for all equations of state
+\details Energies are per unit mass. Besides the single cell calls there are batched calls that convert arrays
+of n cells at once, so that a whole block of cells costs one virtual call. By default they loop over the
+single cell calls, fast equations of state override them with loops the compiler can inline and vectorize.
+*/
+class EquationOfState
+{
+public:
+	virtual double dp2e(double d, double p)const=0;
+
+	virtual double de2p(double d, double e)const=0;
+
+	virtual double dp2c(double d, double p)const=0;
+
+	virtual double de2c(double d, double e)const=0;
+
+	virtual double dp2s(double d, double p)const=0;
+
+	virtual double sd2p(double s, double d)const=0;
+
+	/*! \brief Batched dp2e
+	\param d Densities
+	\param p Pressures
+	\param e Receives the energies
+	\param n Number of cells
+	*/
+	virtual void dp2e(double const* d, double const* p, double *e, size_t n)const;
+
+	//! \brief Batched de2p, same layout as dp2e
+	virtual void de2p(double const* d, double const* e, double *p, size_t n)const;
+
+	//! \brief Batched dp2c, same layout as dp2e
+	virtual void dp2c(double const* d, double const* p, double *c, size_t n)const;
+
+	//! \brief Batched dp2s, same layout as dp2e
+	virtual void dp2s(double const* d, double const* p, double *s, size_t n)const;
+
+	//! \brief Batched sd2p, same layout as dp2e
+	virtual void sd2p(double const* s, double const* d, double *p, size_t n)const;
+
+	virtual ~EquationOfState();
+};
+
+#endif //EQUATIONOFSTATE_HPP
@@ -5,125 +5,247 @@
 
 namespace
 {
-	double CalcFrarefraction(Primitive const& cell, double p,double gamma)
+	// The wave functions take the adiabatic index as a policy, either RuntimeIndex or a RationalIndex whose
+	// powers are resolved at compile time
+	template<class Index> double CalcFrarefraction(Primitive const& cell, double p, Index const& index)
 	{
+		const double gamma = index.Gamma();
 		double cs = sqrt(gamma*cell.pressure/ cell.density);
-		return 2 * cs*(pow(p / cell.pressure, (gamma - 1) / (2 * gamma)) - 1) / (gamma - 1);
+		return 2 * cs*(index.PowRarefaction(p / cell.pressure) - 1) / (gamma - 1);
 	}
 
-	double CalcFshock(Primitive const& cell, double p,double gamma)
+	template<class Index> double CalcFshock(Primitive const& cell, double p, Index const& index)
 	{
+		const double gamma = index.Gamma();
 		double A = 2 / ((gamma + 1) *cell.density);
 		double B = (gamma - 1)*cell.pressure / (gamma + 1);
 		return (p - cell.pressure)*sqrt(A / (p + B));
 	}
 
-	double dCalcFrarefraction(Primitive const& cell, double p, double gamma)
+	template<class Index> double dCalcFrarefraction(Primitive const& cell, double p, Index const& index)
 	{
-		return (p + gamma*p + 3 * gamma*cell.pressure - cell.pressure)*pow(p + gamma*p - cell.pressure + 
-			gamma*cell.pressure, -1.5) / sqrt(2 * cell.density);
+		const double gamma = index.Gamma();
+		double cs = sqrt(gamma*cell.pressure/ cell.density);
+		return index.PowShock(cell.pressure / p) / (cell.density*cs);
 	}
 
-	double dCalcFshock(Primitive const& cell, double p, double gamma)
+	template<class Index> double dCalcFshock(Primitive const& cell, double p, Index const& index)
 	{
-		double cs = sqrt(gamma*cell.pressure/ cell.density);
-		return pow(cell.pressure / p, (gamma + 1) / (2 * gamma)) / (cell.density*cs);
+		const double gamma = index.Gamma();
+		return (p + gamma*p + 3 * gamma*cell.pressure - cell.pressure)*index.PowMinusThreeHalves(p + gamma*p -
+			cell.pressure + gamma*cell.pressure) / sqrt(2 * cell.density);
 	}
 
-	RSsolution GetFirstGuess(Primitive const & left, Primitive const & right,double gamma)
+	/* Toro's adaptive choice: the linearized estimate when the jump is weak, the two rarefaction estimate for
+	expansions, which is exact when both waves are rarefactions, and the two shock estimate for compressions. The
+	two rarefaction estimate is only evaluated when it is chosen, its powers dominate the cost. */
+	template<class Index> double GetFirstGuess(double dl, double pl, double vl, double dr, double pr, double vr,
+		Index const& index)
 	{
-		RSsolution res;
-		double csl = sqrt(gamma*left.pressure / left.density);
-		double csr = sqrt(gamma*right.pressure / right.density);
-		res.pressure = pow((csl+csr-0.5*(gamma-1)*(right.velocity-left.velocity))/(csl*pow(
-			left.pressure,(-gamma+1)/(2*gamma))+ csr*pow(
-				right.pressure, (-gamma + 1) / (2 * gamma))),2*gamma/(gamma-1));
-		return res;
+		const double gamma = index.Gamma();
+		const double csl = sqrt(gamma*pl / dl);
+		const double csr = sqrt(gamma*pr / dr);
+		const double ppv = std::max(0.0, 0.5*(pl + pr) - 0.125*(vr - vl)*(dl + dr)*(csl + csr));
+		const double pmin = std::min(pl, pr);
+		const double pmax = std::max(pl, pr);
+		if ((pmax < 2 * pmin) && (ppv >= pmin) && (ppv <= pmax))
+			return ppv;
+		if (ppv < pmin)
+			return index.PowTwoRarefaction((csl + csr - 0.5*(gamma - 1)*(vr - vl)) /
+				(csl*index.PowMinusRarefaction(pl) + csr*index.PowMinusRarefaction(pr)));
+		const double gl = sqrt(2 / ((gamma + 1)*dl) / (ppv + (gamma - 1)*pl / (gamma + 1)));
+		const double gr = sqrt(2 / ((gamma + 1)*dr) / (ppv + (gamma - 1)*pr / (gamma + 1)));
+		return (gl*pl + gr*pr - (vr - vl)) / (gl + gr);
 	}
 
-	double GetValue(Primitive const & left, Primitive const & right,double p,double gamma)
+	template<class Index> double GetValue(Primitive const & left, Primitive const & right, double p,
+		Index const& index)
 	{
 		double res = right.velocity-left.velocity;
 		if (p > left.pressure)
-			res += CalcFshock(left, p, gamma);
+			res += CalcFshock(left, p, index);
 		else
-			res += CalcFrarefraction(left, p,gamma);
+			res += CalcFrarefraction(left, p, index);
 		if (p > right.pressure)
-			res += CalcFshock(right, p, gamma);
+			res += CalcFshock(right, p, index);
 		else
-			res += CalcFrarefraction(right, p, gamma);
+			res += CalcFrarefraction(right, p, index);
 		return res;
 	}
 
-	double GetdValue(Primitive const & left, Primitive const & right, double p, double gamma)
+	template<class Index> double GetdValue(Primitive const & left, Primitive const & right, double p,
+		Index const& index)
 	{
 		double res = 0;
 		if (p > left.pressure)
-			res += dCalcFshock(left, p, gamma);
+			res += dCalcFshock(left, p, index);
 		else
-			res += dCalcFrarefraction(left, p, gamma);
+			res += dCalcFrarefraction(left, p, index);
 		if (p > right.pressure)
-			res += dCalcFshock(right, p, gamma);
+			res += dCalcFshock(right, p, index);
 		else
-			res += dCalcFrarefraction(right, p, gamma);
+			res += dCalcFrarefraction(right, p, index);
 		return res;
 	}
-}
 
-ExactRS::ExactRS(double gamma):gamma_(gamma)
-{}
+	void ThrowSolveError(Primitive const& left, Primitive const& right)
+	{
+		UniversalError eo("Too many iterations in RS");
+		eo.AddEntry("Left density", left.density);
+		eo.AddEntry("Left pressure", left.pressure);
+		eo.AddEntry("Left velocity", left.velocity);
+		eo.AddEntry("Right density", right.density);
+		eo.AddEntry("Right pressure", right.pressure);
+		eo.AddEntry("Right velocity", right.velocity);
+		throw eo;
+	}
 
-ExactRS::~ExactRS()
-{}
+	// Relative change of the pressure at which the Newton iteration stops. The convergence is quadratic, so the
+	// pressure is then accurate to about the square of this.
+	const double newton_tolerance = 1e-7;
 
-RSsolution ExactRS::Solve(Primitive const & left, Primitive const & right)const
-{
-	const double eps = 1e-7;
-	// Is there a vaccum?
-	double dv = right.velocity - left.velocity;
-	double soundspeeds = 2 * (sqrt(gamma_*left.pressure / left.density) + sqrt(gamma_*right.pressure / right.density)) / (gamma_ - 1);
-	if (dv > soundspeeds)
+	// Most Newton iterations for one interface
+	const size_t max_iterations = 200;
+
+	/* The next Newton iterate. The wave functions increase and are concave, so from below the iteration
+	approaches the root without crossing it, and only a step from above can overshoot. A step that would take
+	away more than 90% of the pressure is cut short so that the pressure stays positive. */
+	double NewtonStep(double p, double value, double dvalue)
+	{
+		return std::max(p - value / dvalue, 0.1*p);
+	}
+
+	// Newton iteration of a single interface, counter is set to the number of iterations
+	template<class Index> RSsolution SolveSingle(Primitive const& left, Primitive const& right, Index const& index,
+		size_t &counter)
 	{
+		const double gamma = index.Gamma();
+		counter = 0;
+		// Is there a vaccum?
+		double dv = right.velocity - left.velocity;
+		double soundspeeds = 2 * (sqrt(gamma*left.pressure / left.density) + sqrt(gamma*right.pressure /
+			right.density)) / (gamma - 1);
+		if (dv > soundspeeds)
+		{
+			RSsolution res;
+			res.pressure = 0;
+			res.velocity = 0;
+			return res;
+		}
 		RSsolution res;
-		res.pressure = 0;
+		res.pressure = GetFirstGuess(left.density, left.pressure, left.velocity, right.density, right.pressure,
+			right.velocity, index);
 		res.velocity = 0;
+		if (res.pressure < 0)
+		{
+			res.pressure = 0;
+			return res;
+		}
+		for (;;)
+		{
+			const double p = res.pressure;
+			res.pressure = NewtonStep(p, GetValue(left, right, p, index), GetdValue(left, right, p, index));
+			++counter;
+			if (fabs(res.pressure - p) <= newton_tolerance*res.pressure)
+				break;
+			if (counter >= max_iterations)
+				ThrowSolveError(left, right);
+		}
+		double fr = (res.pressure > right.pressure) ? CalcFshock(right, res.pressure, index) :
+			CalcFrarefraction(right, res.pressure, index);
+		double fl = (res.pressure > left.pressure) ? CalcFshock(left, res.pressure, index) :
+			CalcFrarefraction(left, res.pressure, index);
+		res.velocity = 0.5*(left.velocity + right.velocity) + 0.5*(fr-fl);
 		return res;
 	}
-	RSsolution res = GetFirstGuess(left, right,gamma_);
-	res.velocity = 0;
-	if (res.pressure < 0)
+
+	// Solves a range one interface at a time and returns the total number of iterations
+	template<class Index> size_t SolveEach(vector<pair<Primitive, Primitive> > const& states,
+		vector<RSsolution>& res, size_t begin, size_t end, Index const& index)
 	{
-		res.pressure = 0;
-		return res;
+		size_t total_iterations = 0;
+		for (size_t i = begin; i < end; ++i)
+		{
+			size_t counter = 0;
+			res[i] = SolveSingle(states[i].first, states[i].second, index, counter);
+			total_iterations += counter;
+		}
+		return total_iterations;
 	}
-	double value = GetValue(left, right, res.pressure, gamma_);
-	//	double Cs = std::max(sqrt(gamma_*left.pressure / left.density), sqrt(gamma_*right.pressure / right.density));
-	double dp = 0;
-	double p = res.pressure;
+}
+
+ExactRS::ExactRS(double gamma):gamma_(gamma),index_(ClassifyIndex(gamma)),solve_count_(0),iteration_count_(0),last_iterations_(0)
+{}
+
+ExactRS::~ExactRS()
+{}
+
+RSsolution ExactRS::Solve(Primitive const & left, Primitive const & right)const
+{
+#pragma omp atomic
+	++solve_count_;
+#pragma omp atomic write
+	last_iterations_ = 0;
 	size_t counter = 0;
-	do
+	RSsolution res;
+	switch (index_)
 	{
-		p = res.pressure;
-		dp = value / GetdValue(left, right, res.pressure, gamma_);
-		res.pressure -= std::max(std::min(0.5*dp,res.pressure*0.1),-0.1*res.pressure);
-		value = GetValue(left, right, res.pressure, gamma_);
-		++counter;
-		if (counter > 200)
-		{
-			UniversalError eo("Too many iterations in RS");
-			eo.AddEntry("Left density", left.density);
-			eo.AddEntry("Left pressure", left.pressure);
-			eo.AddEntry("Left velocity", left.velocity);
-			eo.AddEntry("Right density", right.density);
-			eo.AddEntry("Right pressure", right.pressure);
-			eo.AddEntry("Right velocity", right.velocity);
-			throw eo;
-		}
-	} while ((fabs(dp) > eps*(p+res.pressure))&&(dv*eps>value));
-	double fr = (res.pressure > right.pressure) ? CalcFshock(right, res.pressure, gamma_) : CalcFrarefraction(
-		right, res.pressure, gamma_);
-	double fl = (res.pressure > left.pressure) ? CalcFshock(left, res.pressure, gamma_) : CalcFrarefraction(
-		left, res.pressure, gamma_);
-	res.velocity = 0.5*(left.velocity + right.velocity) + 0.5*(fr-fl);
+	case five_thirds_index:
+		res = SolveSingle(left, right, RationalIndex<5, 3>(), counter);
+		break;
+	case four_thirds_index:
+		res = SolveSingle(left, right, RationalIndex<4, 3>(), counter);
+		break;
+	default:
+		res = SolveSingle(left, right, RuntimeIndex(gamma_), counter);
+	}
+#pragma omp atomic write
+	last_iterations_ = counter;
+#pragma omp atomic
+	iteration_count_ += counter;
 	return res;
 }
+
+void ExactRS::Solve(vector<pair<Primitive, Primitive> > const& states, vector<RSsolution>& res, size_t begin,
+	size_t end) const
+{
+	size_t total_iterations = 0;
+	switch (index_)
+	{
+	case five_thirds_index:
+		total_iterations = SolveEach(states, res, begin, end, RationalIndex<5, 3>());
+		break;
+	case four_thirds_index:
+		total_iterations = SolveEach(states, res, begin, end, RationalIndex<4, 3>());
+		break;
+	default:
+		total_iterations = SolveEach(states, res, begin, end, RuntimeIndex(gamma_));
+	}
+	// Concurrent solves of disjoint ranges only share the counters
+	const size_t solved = end > begin ? end - begin : 0;
+#pragma omp atomic
+	iteration_count_ += total_iterations;
+#pragma omp atomic
+	solve_count_ += solved;
+}
+
+size_t ExactRS::GetSolveCount() const
+{
+	return solve_count_;
+}
+
+size_t ExactRS::GetIterationCount() const
+{
+	return iteration_count_;
+}
+
+size_t ExactRS::GetLastIterationCount() const
+{
+	return last_iterations_;
+}
+
+void ExactRS::ResetIterationCount()
+{
+	solve_count_ = 0;
+	iteration_count_ = 0;
+}
@@ -1,25 +1,43 @@
 #ifndef EXACTRS_HPP
 #define EXACTRS_HPP 1
 
-#include "Primitive.hpp"
-
-struct RSsolution
-{
-	double velocity;
-	double pressure;
-};
-
-
-class ExactRS
+#include "RiemannSolver.hpp"
+#include "AdiabaticIndex.hpp"
+
+/*! \brief Exact Riemann solver
+\details Adiabatic indices of 5/3 and 4/3 use specializations whose powers are resolved at compile time, any
+other index is handled at run time
+*/
+class ExactRS final : public RiemannSolver
 {
 private:
 	const double gamma_;
+	const IndexKind index_;
+	mutable size_t solve_count_;
+	mutable size_t iteration_count_;
+	mutable size_t last_iterations_;
 
 public:
 	ExactRS(double gama);
 	~ExactRS();
 
+	using RiemannSolver::Solve;
+
 	RSsolution Solve(Primitive const& left, Primitive const& right)const;
+
+	void Solve(vector<pair<Primitive, Primitive> > const& states, vector<RSsolution> &res, size_t begin,
+		size_t end)const;
+
+	//! \brief Number of Riemann problems solved since the last reset
+	size_t GetSolveCount()const;
+
+	//! \brief Total number of Newton iterations since the last reset
+	size_t GetIterationCount()const;
+
+	//! \brief Number of Newton iterations taken by the last single interface solve
+	size_t GetLastIterationCount()const;
+
+	void ResetIterationCount();
 };
 
 
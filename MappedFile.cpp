@@ -0,0 +1,82 @@
+#include "MappedFile.hpp"
+#include "universal_error.hpp"
+#include <cstdio>
+#if defined(__unix__) || defined(__APPLE__)
+#define MAPPEDFILE_POSIX 1
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+namespace
+{
+	UniversalError file_error(string const& message, string const& fname)
+	{
+		UniversalError eo(message);
+		eo.Append2ErrorMessage(" " + fname);
+		return eo;
+	}
+}
+
+MappedFile::MappedFile(string const& fname, bool sequential):data_(0),size_(0),buffer_(),mapped_(false)
+{
+#ifdef MAPPEDFILE_POSIX
+	const int fd = open(fname.c_str(), O_RDONLY);
+	struct stat info;
+	if (fd < 0 || fstat(fd, &info) != 0)
+	{
+		if (fd >= 0)
+			close(fd);
+		throw file_error("Could not open", fname);
+	}
+	size_ = static_cast<size_t>(info.st_size);
+	if (size_ == 0)
+	{
+		close(fd);
+		return;
+	}
+	void *map = mmap(0, size_, PROT_READ, MAP_PRIVATE, fd, 0);
+	close(fd);
+	if (map == MAP_FAILED)
+		throw file_error("Could not map", fname);
+	if (sequential)
+	{
+		madvise(map, size_, MADV_SEQUENTIAL);
+		madvise(map, size_, MADV_WILLNEED);
+	}
+	data_ = static_cast<char const*>(map);
+	mapped_ = true;
+#else
+	(void)sequential;
+	FILE *f = fopen(fname.c_str(), "rb");
+	if (!f)
+		throw file_error("Could not open", fname);
+	fseek(f, 0, SEEK_END);
+	buffer_.resize(static_cast<size_t>(ftell(f)));
+	fseek(f, 0, SEEK_SET);
+	const size_t read = buffer_.empty() ? 0 : fread(&buffer_[0], 1, buffer_.size(), f);
+	fclose(f);
+	if (read != buffer_.size())
+		throw file_error("Could not read", fname);
+	data_ = buffer_.empty() ? 0 : &buffer_[0];
+	size_ = buffer_.size();
+#endif
+}
+
+MappedFile::~MappedFile()
+{
+#ifdef MAPPEDFILE_POSIX
+	if (mapped_)
+		munmap(const_cast<char*>(data_), size_);
+#endif
+}
+
+bool MappedFile::CanMap()
+{
+#ifdef MAPPEDFILE_POSIX
+	return true;
+#else
+	return false;
+#endif
+}
@@ -0,0 +1,53 @@
+#ifndef MAPPEDFILE_HPP
+#define MAPPEDFILE_HPP 1
+
+#include <string>
+#include <vector>
+
+using namespace std;
+
+/*! \brief The read only contents of a file, memory mapped where the system allows it
+\details Without mmap the file is read into memory instead, IsMapped tells the two apart. Mapped pages are
+read from disk on first access and shared with the page cache, so nothing is copied.
+*/
+class MappedFile
+{
+private:
+	char const* data_;
+	size_t size_;
+	vector<char> buffer_;
+	bool mapped_;
+
+	MappedFile(MappedFile const&);
+
+	MappedFile& operator=(MappedFile const&);
+
+public:
+	/*! \brief Maps a file, throws a UniversalError if it can not be opened
+	\param fname The name of the file
+	\param sequential Tells the system that the file will be read from start to end once
+	*/
+	explicit MappedFile(string const& fname, bool sequential = false);
+
+	~MappedFile();
+
+	char const* data()const
+	{
+		return data_;
+	}
+
+	size_t size()const
+	{
+		return size_;
+	}
+
+	bool IsMapped()const
+	{
+		return mapped_;
+	}
+
+	//! \brief Whether files are mapped on this system, rather than read
+	static bool CanMap();
+};
+
+#endif //MAPPEDFILE_HPP
@@ -1,22 +1,96 @@
 #ifndef MINMOD_HPP
 #define MINMOD_HPP 1
 
-#include "Primitive.hpp"
+#include "StateArrays.hpp"
 #include "Boundary.hpp"
 #include <vector>
+#include <cmath>
+#include <algorithm>
 
 using namespace std;
 
-class MinMod
+/*! \brief Piecewise linear reconstruction with the minmod limiter
+\details The boundary type is a policy, the slope calculation is in the header so that it can be inlined into
+the engine
+*/
+template<class BoundaryType> class MinModT
 {
 private:
-	Boundary const& boundary_;
+	BoundaryType const& boundary_;
 public:
-	MinMod(Boundary const& boundary);
-	~MinMod();
+	MinModT(BoundaryType const& boundary):boundary_(boundary)
+	{}
 
-	void GetInterpolatedValues(vector<Primitive> const& cells, vector<double> const& edges, vector<pair<Primitive,
-		Primitive> > & values)const;
+	~MinModT()
+	{}
+
+	/*! \brief Reconstructs the values at both faces of a cell away from the boundary
+	\param cells The cells
+	\param edges The edges
+	\param i Index of the cell, must have two neighbours
+	\param left Value at the left face
+	\param right Value at the right face
+	*/
+	void GetCellFaces(PrimitiveArrays const& cells, vector<double> const& edges, size_t i, Primitive &left,
+		Primitive &right)const
+	{
+		Primitive slope;
+		const Primitive sl = (cells[i] - cells[i - 1]) / (0.5*(edges[i + 1] - edges[i-1]));
+		const Primitive sr = (cells[i+1] - cells[i]) / (0.5*(edges[i + 2] - edges[i]));
+		const Primitive sc = (cells[i+1] - cells[i - 1]) / (0.5*(edges[i + 2]+edges[i + 1] - edges[i - 1]
+			- edges[i]));
+		if (sl.density*sr.density < 0)
+			slope.density = 0;
+		else
+			slope.density = std::min(std::fabs(sl.density), std::min(std::fabs(sr.density), std::fabs(sc.density))) * (sl.density > 0 ?
+				1 : -1);
+		if (sl.pressure*sr.pressure < 0)
+			slope.pressure = 0;
+		else
+			slope.pressure = std::min(std::fabs(sl.pressure), std::min(std::fabs(sr.pressure), std::fabs(sc.pressure))) * (sl.pressure > 0 ?
+				1 : -1);
+		if (sl.velocity*sr.velocity < 0)
+			slope.velocity = 0;
+		else
+			slope.velocity = std::min(std::fabs(sl.velocity), std::min(std::fabs(sr.velocity), std::fabs(sc.velocity))) * (sl.velocity > 0 ?
+				1 : -1);
+		left = cells[i] - slope * (0.5*(edges[i + 1] - edges[i]));
+		right = cells[i] + slope * (0.5*(edges[i + 1] - edges[i]));
+	}
+
+	/*! \brief Values at the boundary interfaces, laid out as returned by Boundary::GetBoundaryValues
+	\param cells The cells
+	\param edges The edges
+	\param left Ghost value, left face of the first cell and right face of the first cell
+	\param right Left face of the last cell, right face of the last cell and ghost value
+	*/
+	void GetBoundaryFaces(PrimitiveArrays const& cells, vector<double> const& edges, Primitive (&left)[3],
+		Primitive (&right)[3])const
+	{
+		boundary_.GetBothBoundaryValues(cells, edges, left, right);
+	}
+
+	void GetInterpolatedValues(PrimitiveArrays const& cells, vector<double> const& edges, vector<pair<Primitive,
+		Primitive> > & values)const
+	{
+		size_t N = edges.size();
+		values.resize(N);
+		// Do bulk edges
+		for (size_t i = 1; i < N - 2; ++i)
+			GetCellFaces(cells, edges, i, values[i].second, values[i + 1].first);
+		// Do boundaries
+		Primitive left[3], right[3];
+		GetBoundaryFaces(cells, edges, left, right);
+		values[0].first = left[0];
+		values[0].second = left[1];
+		values[1].first = left[2];
+		values[N-2].second = right[0];
+		values[N-1].first = right[1];
+		values[N-1].second = right[2];
+	}
 };
 
+//! \brief Reconstruction with any boundary, through its virtual functions
+typedef MinModT<Boundary> MinMod;
+
 #endif
@@ -0,0 +1,31 @@
+#include "ParabolicOrbit.hpp"
+#include <cmath>
+
+ParabolicOrbit::ParabolicOrbit(double Rp, double M):Rp_(Rp),time_scale_(sqrt(2 * Rp*Rp*Rp / M)),memo_times_(),
+	memo_values_(),memo_next_(0),memo_count_(0)
+{}
+
+double ParabolicOrbit::GetHalfAngleTangent(double t) const
+{
+	for (size_t i = 0; i < memo_count_; ++i)
+		if (memo_times_[i] == t)
+			return memo_values_[i];
+	const double res = 2 * sinh(asinh(1.5*t / time_scale_) / 3);
+	memo_times_[memo_next_] = t;
+	memo_values_[memo_next_] = res;
+	memo_next_ = (memo_next_ + 1) % memo_size;
+	if (memo_count_ < memo_size)
+		++memo_count_;
+	return res;
+}
+
+double ParabolicOrbit::GetTrueAnomaly(double t) const
+{
+	return 2 * atan(GetHalfAngleTangent(t));
+}
+
+double ParabolicOrbit::GetDistance(double t) const
+{
+	const double D = GetHalfAngleTangent(t);
+	return Rp_*(1 + D*D);
+}
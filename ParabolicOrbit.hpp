@@ -0,0 +1,40 @@
+#ifndef PARABOLICORBIT_HPP
+#define PARABOLICORBIT_HPP 1
+
+#include <cstddef>
+
+/*! \brief Parabolic orbit of a star around a point mass, with the time measured from pericenter
+\details Barker's equation t = sqrt(2Rp^3/M)(D+D^3/3), where D = tan(f/2) and f is the true anomaly, is a cubic
+with the single real root D = 2sinh(asinh(1.5tau)/3), tau = t/sqrt(2Rp^3/M). The distance is Rp(1+D^2), so
+both are found to full precision without iterating. The last few times asked for are remembered, the source
+terms ask for the same times several times per step.
+*/
+class ParabolicOrbit
+{
+private:
+	static const size_t memo_size = 4;
+	double Rp_;
+	double time_scale_;
+	mutable double memo_times_[memo_size];
+	mutable double memo_values_[memo_size];
+	mutable size_t memo_next_;
+	mutable size_t memo_count_;
+
+	//! \brief tan(f/2) at a time
+	double GetHalfAngleTangent(double t)const;
+
+public:
+	/*!
+	\param Rp Pericenter distance
+	\param M Mass of the central object
+	*/
+	ParabolicOrbit(double Rp, double M);
+
+	//! \brief The true anomaly at a time, zero at pericenter
+	double GetTrueAnomaly(double t)const;
+
+	//! \brief Distance from the central object at a time
+	double GetDistance(double t)const;
+};
+
+#endif //PARABOLICORBIT_HPP
@@ -0,0 +1,122 @@
+#include "RSCache.hpp"
+#include <cmath>
+#include <algorithm>
+
+RSCache::Workspace::Workspace():states(),res(),index()
+{}
+
+RSCache::RSCache(double tolerance):tolerance_(tolerance),states_(),solutions_(),valid_(),hits_(0),misses_(0),
+	workspaces_(1)
+{}
+
+void RSCache::SetTolerance(double tolerance)
+{
+	tolerance_ = tolerance;
+	Clear();
+}
+
+double RSCache::GetTolerance() const
+{
+	return tolerance_;
+}
+
+bool RSCache::IsClose(Primitive const & cell, Primitive const & stored) const
+{
+	// Velocities are compared on the scale of the isothermal sound speed
+	return std::fabs(cell.density - stored.density) <= tolerance_*stored.density &&
+		std::fabs(cell.pressure - stored.pressure) <= tolerance_*stored.pressure &&
+		std::fabs(cell.velocity - stored.velocity) <= tolerance_*sqrt(stored.pressure / stored.density);
+}
+
+void RSCache::Solve(RiemannSolver const & rs, vector<pair<Primitive, Primitive> > const & states,
+	vector<RSsolution>& res)
+{
+	size_t N = states.size();
+	res.resize(N);
+	if (states_.size() != N)
+		Reset(N);
+	Solve(rs, states, res, 0, N);
+}
+
+void RSCache::Solve(RiemannSolver const & rs, vector<pair<Primitive, Primitive> > const & states,
+	vector<RSsolution>& res, size_t offset, size_t count, size_t workspace)
+{
+	SolveInterfaces(rs, states, res, offset, offset, offset + count, workspaces_[workspace]);
+}
+
+void RSCache::SolveRange(RiemannSolver const & rs, vector<pair<Primitive, Primitive> > const & states,
+	vector<RSsolution>& res, size_t begin, size_t end, size_t workspace)
+{
+	SolveInterfaces(rs, states, res, 0, begin, end, workspaces_[workspace]);
+}
+
+void RSCache::SolveInterfaces(RiemannSolver const & rs, vector<pair<Primitive, Primitive> > const & states,
+	vector<RSsolution>& res, size_t base, size_t begin, size_t end, Workspace & workspace)
+{
+	workspace.states.clear();
+	workspace.index.clear();
+	for (size_t i = begin; i < end; ++i)
+	{
+		size_t k = i - base;
+		if (valid_[i] && IsClose(states[k].first, states_[i].first) && IsClose(states[k].second, states_[i].second))
+			res[k] = solutions_[i];
+		else
+		{
+			workspace.states.push_back(states[k]);
+			workspace.index.push_back(i);
+		}
+	}
+	size_t Nmiss = workspace.index.size();
+	workspace.res.resize(Nmiss);
+	rs.Solve(workspace.states, workspace.res, 0, Nmiss);
+	for (size_t j = 0; j < Nmiss; ++j)
+	{
+		size_t i = workspace.index[j];
+		res[i - base] = workspace.res[j];
+		solutions_[i] = workspace.res[j];
+		states_[i] = workspace.states[j];
+		valid_[i] = 1;
+	}
+	const size_t Nhit = (end - begin) - Nmiss;
+#pragma omp atomic
+	misses_ += Nmiss;
+#pragma omp atomic
+	hits_ += Nhit;
+}
+
+void RSCache::SetWorkspaceCount(size_t n)
+{
+	workspaces_.resize(std::max(n, static_cast<size_t>(1)));
+}
+
+void RSCache::Reset(size_t N)
+{
+	RSsolution empty;
+	empty.pressure = 0;
+	empty.velocity = 0;
+	states_.assign(N, pair<Primitive, Primitive>());
+	solutions_.assign(N, empty);
+	valid_.assign(N, 0);
+}
+
+size_t RSCache::size() const
+{
+	return states_.size();
+}
+
+void RSCache::Clear()
+{
+	states_.clear();
+	solutions_.clear();
+	valid_.clear();
+}
+
+size_t RSCache::GetHits() const
+{
+	return hits_;
+}
+
+size_t RSCache::GetMisses() const
+{
+	return misses_;
+}
@@ -0,0 +1,94 @@
+#ifndef RSCACHE_HPP
+#define RSCACHE_HPP 1
+
+#include "RiemannSolver.hpp"
+
+/*! \brief Remembers the last Riemann problem solved at each interface
+\details A stored solution is reused as long as the new left and right states are within a relative tolerance
+of the states it was computed from. The stored states are only replaced on a miss, so slow drifts do not
+accumulate.
+*/
+class RSCache
+{
+private:
+	double tolerance_;
+	vector<pair<Primitive, Primitive> > states_;
+	vector<RSsolution> solutions_;
+	vector<char> valid_;
+	size_t hits_;
+	size_t misses_;
+
+	//! \brief Scratch space for gathering the misses of one solve
+	struct Workspace
+	{
+		vector<pair<Primitive, Primitive> > states;
+		vector<RSsolution> res;
+		vector<size_t> index;
+
+		Workspace();
+	};
+
+	vector<Workspace> workspaces_;
+
+	bool IsClose(Primitive const& cell, Primitive const& stored)const;
+
+	// The entry of interface i in states and res is i-base
+	void SolveInterfaces(RiemannSolver const& rs, vector<pair<Primitive, Primitive> > const& states,
+		vector<RSsolution> &res, size_t base, size_t begin, size_t end, Workspace &workspace);
+
+public:
+	explicit RSCache(double tolerance = 0);
+
+	void SetTolerance(double tolerance);
+
+	double GetTolerance()const;
+
+	/*! \brief Solves all interfaces, calling the solver only for the ones that changed
+	\param rs The Riemann solver
+	\param states Left and right states of each interface
+	\param res The solutions
+	*/
+	void Solve(RiemannSolver const& rs, vector<pair<Primitive, Primitive> > const& states,
+		vector<RSsolution> &res);
+
+	/*! \brief Solves a contiguous run of interfaces
+	\param rs The Riemann solver
+	\param states Left and right states, entry k belongs to interface offset+k
+	\param res The solutions, entry k belongs to interface offset+k
+	\param offset Index of the first interface
+	\param count Number of interfaces to solve
+	\param workspace Index of the scratch space to use
+	*/
+	void Solve(RiemannSolver const& rs, vector<pair<Primitive, Primitive> > const& states,
+		vector<RSsolution> &res, size_t offset, size_t count, size_t workspace = 0);
+
+	/*! \brief Solves the interfaces in [begin,end) of arrays that hold all interfaces
+	\param rs The Riemann solver
+	\param states Left and right states of each interface
+	\param res The solutions, must already have one entry per interface
+	\param begin Index of the first interface
+	\param end One past the index of the last interface
+	\param workspace Index of the scratch space to use
+	*/
+	void SolveRange(RiemannSolver const& rs, vector<pair<Primitive, Primitive> > const& states,
+		vector<RSsolution> &res, size_t begin, size_t end, size_t workspace = 0);
+
+	/*! \brief Sets the number of scratch spaces
+	\details Solves of disjoint interfaces that use different scratch spaces may run concurrently
+	*/
+	void SetWorkspaceCount(size_t n);
+
+	//! \brief Forgets all stored solutions and sets the number of interfaces
+	void Reset(size_t N);
+
+	size_t size()const;
+
+	//! \brief Forgets all stored solutions
+	void Clear();
+
+	size_t GetHits()const;
+
+	size_t GetMisses()const;
+};
+
+#endif //RSCACHE_HPP
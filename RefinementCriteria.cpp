@@ -0,0 +1,74 @@
+#include "RefinementCriteria.hpp"
+#include <algorithm>
+#include <cmath>
+
+RefinementCriteria::~RefinementCriteria()
+{}
+
+namespace
+{
+	double RelativeJump(double a, double b)
+	{
+		return std::fabs(a - b) / std::min(a, b);
+	}
+
+	double MaxJump(PrimitiveArrays const& cells, size_t left)
+	{
+		return std::max(RelativeJump(cells.density[left], cells.density[left + 1]),
+			RelativeJump(cells.pressure[left], cells.pressure[left + 1]));
+	}
+
+	double ThermalEnergy(ExtensiveArrays const& extensives, size_t index)
+	{
+		const double momentum = extensives.momentum[index];
+		return extensives.energy[index] - 0.5*momentum*momentum / extensives.mass[index];
+	}
+}
+
+StandardRefinement::StandardRefinement(double max_jump, double min_jump, double max_mass_ratio, double min_width,
+	double density_floor):
+	max_jump_(max_jump),min_jump_(min_jump),max_mass_ratio_(max_mass_ratio),min_width_(min_width),
+	density_floor_(density_floor)
+{}
+
+bool StandardRefinement::ShouldSplit(PrimitiveArrays const & cells, vector<double> const & edges,
+	ExtensiveArrays const & extensives, size_t index) const
+{
+	if (edges[index + 1] - edges[index] < 2 * min_width_ || cells.density[index] < density_floor_)
+		return false;
+	const size_t N = cells.size();
+	if (index > 0 && cells.density[index - 1] >= density_floor_ && (MaxJump(cells, index - 1) > max_jump_ ||
+		extensives.mass[index] > max_mass_ratio_*extensives.mass[index - 1]))
+		return true;
+	if (index + 1 < N && cells.density[index + 1] >= density_floor_ && (MaxJump(cells, index) > max_jump_ ||
+		extensives.mass[index] > max_mass_ratio_*extensives.mass[index + 1]))
+		return true;
+	return false;
+}
+
+bool StandardRefinement::ShouldMerge(PrimitiveArrays const & cells, vector<double> const & edges,
+	ExtensiveArrays const & extensives, size_t index) const
+{
+	if (edges[index + 1] - edges[index] < min_width_ || edges[index + 2] - edges[index + 1] < min_width_)
+		return true;
+	if (cells.density[index] < density_floor_ && cells.density[index + 1] < density_floor_)
+		return true;
+	const size_t N = cells.size();
+	// The pair and both its neighbours are smooth
+	for (size_t i = (index > 0) ? index - 1 : index; i < std::min(index + 2, N - 1); ++i)
+		if (MaxJump(cells, i) > min_jump_)
+			return false;
+	// Merging turns the kinetic energy of the relative motion into heat
+	const double m0 = extensives.mass[index];
+	const double m1 = extensives.mass[index + 1];
+	const double dv = cells.velocity[index + 1] - cells.velocity[index];
+	if (0.5*m0*m1 / (m0 + m1)*dv*dv > min_jump_*(ThermalEnergy(extensives, index) +
+		ThermalEnergy(extensives, index + 1)))
+		return false;
+	const double mass = m0 + m1;
+	if (index > 0 && mass > max_mass_ratio_*extensives.mass[index - 1])
+		return false;
+	if (index + 2 < N && mass > max_mass_ratio_*extensives.mass[index + 2])
+		return false;
+	return true;
+}
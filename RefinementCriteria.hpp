@@ -0,0 +1,73 @@
+#ifndef REFINEMENTCRITERIA_HPP
+#define REFINEMENTCRITERIA_HPP 1
+
+#include "StateArrays.hpp"
+#include <vector>
+
+using namespace std;
+
+//! \brief Decides which cells hdsim splits in two and which neighbouring cells it merges
+class RefinementCriteria
+{
+public:
+	/*! \brief Should a cell be split into two halves
+	\param cells The cells
+	\param edges The edges
+	\param extensives The extensives
+	\param index Index of the cell
+	\return True to split
+	*/
+	virtual bool ShouldSplit(PrimitiveArrays const& cells, vector<double> const& edges,
+		ExtensiveArrays const& extensives, size_t index)const=0;
+
+	/*! \brief Should a cell be merged with the cell on its right
+	\param cells The cells
+	\param edges The edges
+	\param extensives The extensives
+	\param index Index of the left cell of the pair
+	\return True to merge
+	*/
+	virtual bool ShouldMerge(PrimitiveArrays const& cells, vector<double> const& edges,
+		ExtensiveArrays const& extensives, size_t index)const=0;
+
+	virtual ~RefinementCriteria();
+};
+
+/*! \brief Refines where the flow has strong gradients and coarsens where it is smooth
+\details A cell splits when the density or pressure jumps to a neighbour by more than max_jump, relative to the
+smaller value, or when it is more than max_mass_ratio times heavier than a neighbour, as long as the halves are
+at least min_width wide. Two cells merge when all the jumps between them and their neighbours are below
+min_jump, the kinetic energy of their relative motion is below min_jump times their thermal energy, and the
+merged cell is at most max_mass_ratio times heavier than its neighbours. Cells narrower than min_width always
+merge. Cells with a density below density_floor, such as a near vacuum atmosphere, never split, merge with each
+other without the other tests and are ignored by the tests of their denser neighbours.
+*/
+class StandardRefinement : public RefinementCriteria
+{
+private:
+	const double max_jump_;
+	const double min_jump_;
+	const double max_mass_ratio_;
+	const double min_width_;
+	const double density_floor_;
+
+public:
+	/*!
+	\param max_jump Relative jump that splits a cell
+	\param min_jump Relative jump below which cells may merge, smaller than max_jump
+	\param max_mass_ratio Largest mass ratio of neighbouring cells
+	\param min_width Smallest cell width. The time step shrinks with it, about a quarter of the unrefined width
+	keeps refinement cheaper than a finer uniform mesh, see tools/refinement.
+	\param density_floor Density below which cells are not refined
+	*/
+	StandardRefinement(double max_jump, double min_jump, double max_mass_ratio, double min_width,
+		double density_floor = 0);
+
+	bool ShouldSplit(PrimitiveArrays const& cells, vector<double> const& edges, ExtensiveArrays const& extensives,
+		size_t index)const;
+
+	bool ShouldMerge(PrimitiveArrays const& cells, vector<double> const& edges, ExtensiveArrays const& extensives,
+		size_t index)const;
+};
+
+#endif //REFINEMENTCRITERIA_HPP
@@ -0,0 +1,17 @@
+#include "RiemannSolver.hpp"
+
+void RiemannSolver::Solve(vector<pair<Primitive, Primitive> > const& states, vector<RSsolution>& res, size_t begin,
+	size_t end) const
+{
+	for (size_t i = begin; i < end; ++i)
+		res[i] = Solve(states[i].first, states[i].second);
+}
+
+void RiemannSolver::Solve(vector<pair<Primitive, Primitive> > const& states, vector<RSsolution>& res) const
+{
+	res.resize(states.size());
+	Solve(states, res, 0, states.size());
+}
+
+RiemannSolver::~RiemannSolver()
+{}
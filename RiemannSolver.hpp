@@ -0,0 +1,39 @@
+#ifndef RIEMANNSOLVER_HPP
+#define RIEMANNSOLVER_HPP 1
+
+#include "Primitive.hpp"
+#include <vector>
+
+using namespace std;
+
+struct RSsolution
+{
+	double velocity;
+	double pressure;
+};
+
+//! \brief Interface for all Riemann solvers, only the velocity and pressure of the contact are needed
+class RiemannSolver
+{
+public:
+	virtual RSsolution Solve(Primitive const& left, Primitive const& right)const=0;
+
+	/*! \brief Solves the Riemann problems of the interfaces in [begin,end)
+	\param states Left and right states of each interface
+	\param res The solutions, must already hold at least end entries
+	\param begin First interface to solve
+	\param end One past the last interface to solve
+	*/
+	virtual void Solve(vector<pair<Primitive, Primitive> > const& states, vector<RSsolution> &res, size_t begin,
+		size_t end)const;
+
+	/*! \brief Solves the Riemann problems of all interfaces
+	\param states Left and right states of each interface
+	\param res The solutions, resized to match states
+	*/
+	void Solve(vector<pair<Primitive, Primitive> > const& states, vector<RSsolution> &res)const;
+
+	virtual ~RiemannSolver();
+};
+
+#endif //RIEMANNSOLVER_HPP
@@ -0,0 +1,122 @@
+#define _USE_MATH_DEFINES
+#include "SelfGravity.hpp"
+#include <cmath>
+
+namespace
+{
+	/* Adds the shells of the cells in [begin,end) in order to start and leaves the sum before each cell in
+	running. Shells are in units of 4pi/3. */
+	double running_sum(double const* x, double const* mass, double start, double *running, size_t begin,
+		size_t end)
+	{
+		double sum = start;
+		for (size_t i = begin; i < end; ++i)
+		{
+			running[i] = sum;
+			sum += mass[i] * (x[i] * x[i] + x[i] * x[i + 1] + x[i + 1] * x[i + 1]);
+		}
+		return sum;
+	}
+
+	// Turns the running sums of [begin,end) into accelerations, start is the mass below the block
+	void accelerations(double const* x, double const* mass, double start, double *acc, size_t begin, size_t end)
+	{
+		const double factor = -4 * M_PI / 3;
+		for (size_t i = begin; i < end; ++i)
+		{
+			const double centre = 0.5*(x[i] + x[i + 1]);
+			// The inner half of the cell's own shell
+			const double inner = 0.5*mass[i] * (centre*centre + centre*x[i] + x[i] * x[i]);
+			acc[i] = factor*(start + acc[i] + inner) / (centre*centre);
+		}
+	}
+}
+
+const size_t SelfGravity::block_size;
+
+SelfGravity::SelfGravity():domain_(0),acc_(),block_starts_()
+{}
+
+void SelfGravity::SetDomain(DomainDecomposition const & domain)
+{
+	domain_ = &domain;
+}
+
+void SelfGravity::Prepare(vector<double> const & edges, ExtensiveArrays const & extensives, double /*time*/) const
+{
+	const size_t N = extensives.size();
+	acc_.resize(N);
+	if (N == 0)
+		return;
+	double const* x = &edges[0];
+	double const* mass = &extensives.mass[0];
+	double *acc = &acc_[0];
+	// Cells before the first block boundary belong to a block that starts on a process to the left
+	const size_t offset = domain_ ? domain_->GetBegin(domain_->GetRank()) : 0;
+	const size_t head = min(N, (block_size - offset % block_size) % block_size);
+	const size_t nblocks = (N - head + block_size - 1) / block_size;
+	block_starts_.resize(nblocks);
+
+	// Totals of the blocks, each summed from zero
+	const int nb = static_cast<int>(nblocks);
+#pragma omp parallel for schedule(static) if(nb > 1)
+	for (int b = 0; b < nb; ++b)
+	{
+		const size_t begin = head + static_cast<size_t>(b)*block_size;
+		block_starts_[static_cast<size_t>(b)] = running_sum(x, mass, 0, acc, begin, min(begin + block_size, N));
+	}
+
+	// The mass below the open block and the running sum within it, from the process on the left
+	double carry[2] = { 0, 0 };
+	if (domain_)
+		domain_->ReceiveFromLeft(carry, 2);
+	const double head_start = carry[0];
+	double below = carry[0];
+	double open = running_sum(x, mass, carry[1], acc, 0, head);
+	if (head > 0 && (offset + head) % block_size == 0)
+	{
+		below += open;
+		open = 0;
+	}
+	for (size_t b = 0; b < nblocks; ++b)
+	{
+		const double total = block_starts_[b];
+		block_starts_[b] = below;
+		if ((offset + min(head + (b + 1)*block_size, N)) % block_size == 0)
+			below += total;
+		else
+			open = total;
+	}
+	carry[0] = below;
+	carry[1] = open;
+	if (domain_)
+		domain_->SendToRight(carry, 2);
+
+	accelerations(x, mass, head_start, acc, 0, head);
+#pragma omp parallel for schedule(static) if(nb > 1)
+	for (int b = 0; b < nb; ++b)
+	{
+		const size_t begin = head + static_cast<size_t>(b)*block_size;
+		accelerations(x, mass, block_starts_[static_cast<size_t>(b)], acc, begin, min(begin + block_size, N));
+	}
+}
+
+void SelfGravity::CalcForce(vector<double> const & /*edges*/, PrimitiveArrays const & cells, double /*time*/,
+	ExtensiveArrays & extensives, double dt, size_t begin, size_t end) const
+{
+	double const* acc = &acc_[0];
+	double const* velocity = &cells.velocity[0];
+	double const* mass = &extensives.mass[0];
+	double *momentum = &extensives.momentum[0];
+	double *energy = &extensives.energy[0];
+	for (size_t i = begin; i < end; ++i)
+	{
+		momentum[i] += mass[i] * acc[i] * dt;
+		energy[i] += mass[i] * acc[i] * dt*velocity[i];
+	}
+}
+
+vector<double> const& SelfGravity::GetAcceleration() const
+{
+	return acc_;
+}
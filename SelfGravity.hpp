@@ -0,0 +1,45 @@
+#ifndef SELFGRAVITY_HPP
+#define SELFGRAVITY_HPP 1
+
+#include "SourceTerm.hpp"
+#include "DomainDecomposition.hpp"
+
+/*! \brief Gravity of a spherical star, with the mesh along a radius from its centre
+\details Each cell stands for a spherical shell of its density, so a cell of mass m between a and b holds
+4pi/3 m(a^2+ab+b^2). The mass enclosed by each cell centre is found from the current masses and edges in
+Prepare, so the pull follows the star as it is compressed and expands. The prefix sum runs over blocks of a fixed
+number of cells that start at fixed global indices. The blocks are summed in parallel and their totals combined
+in order, passed from process to process along the mesh, so the result does not depend on the number of threads
+or processes.
+*/
+class SelfGravity : public SourceTerm
+{
+private:
+	DomainDecomposition const* domain_;
+	// Running sum within the block of each cell until Prepare ends, then the acceleration
+	mutable vector<double> acc_;
+	mutable vector<double> block_starts_;
+
+public:
+	//! \brief Cells of a block of the prefix sum
+	static const size_t block_size = 2048;
+
+	SelfGravity();
+
+	/*! \brief Sums the enclosed mass over all processes of a decomposed mesh
+	\param domain The decomposition, must outlive this object
+	*/
+	void SetDomain(DomainDecomposition const& domain);
+
+	void Prepare(vector<double> const& edges, ExtensiveArrays const& extensives, double time)const;
+
+	using SourceTerm::CalcForce;
+
+	void CalcForce(vector<double> const& edges, PrimitiveArrays const& cells, double time,
+		ExtensiveArrays &extensives, double dt, size_t begin, size_t end)const;
+
+	//! \brief The acceleration of each cell found by the last call to Prepare
+	vector<double> const& GetAcceleration()const;
+};
+
+#endif //SELFGRAVITY_HPP
@@ -0,0 +1,183 @@
+#include "SnapshotReader.hpp"
+#include "MappedFile.hpp"
+#include "universal_error.hpp"
+#include <algorithm>
+#include <cstring>
+
+using namespace H5;
+
+namespace
+{
+	hsize_t dataset_size(CommonFG const& group, string const& caption)
+	{
+		hsize_t dims[1];
+		group.openDataSet(caption).getSpace().getSimpleExtentDims(dims, NULL);
+		return dims[0];
+	}
+
+	// Reads the entries [begin,begin+count) of a one dimensional dataset into res
+	template<class T> void read_range(DataSet const& dataset, DataType const& memtype, hsize_t begin, hsize_t count,
+		T *res)
+	{
+		if (count == 0)
+			return;
+		DataSpace filespace = dataset.getSpace();
+		filespace.selectHyperslab(H5S_SELECT_SET, &count, &begin);
+		DataSpace memspace(1, &count);
+		dataset.read(res, memtype, memspace, filespace);
+	}
+
+	template<class T> T read_entry(CommonFG const& group, string const& caption, DataType const& memtype,
+		hsize_t index)
+	{
+		T res = T();
+		read_range(group.openDataSet(caption), memtype, index, 1, &res);
+		return res;
+	}
+
+	UniversalError range_error(string const& caption, size_t begin, size_t end, size_t size)
+	{
+		UniversalError eo("Range beyond the end of the snapshot");
+		eo.Append2ErrorMessage(" in " + caption);
+		eo.AddEntry("Begin", static_cast<double>(begin));
+		eo.AddEntry("End", static_cast<double>(end));
+		eo.AddEntry("Size", static_cast<double>(size));
+		return eo;
+	}
+}
+
+SnapshotReader::SnapshotReader(string const& fname, size_t index):fname_(fname),
+	file_(H5std_string(fname), H5F_ACC_RDONLY),geometry_(file_.openGroup("geometry")),
+	hydrodynamic_(file_.openGroup("hydrodynamic")),index_(index),cells_(0),cell_offset_(0),edge_offset_(0),map_()
+{
+	const hsize_t total = dataset_size(hydrodynamic_, "density");
+	const bool series = H5Lexists(file_.getId(), "offsets", H5P_DEFAULT) > 0;
+	const hsize_t snapshots = series ? dataset_size(file_, "offsets") : 1;
+	const hsize_t k = static_cast<hsize_t>(index);
+	if (k >= snapshots)
+	{
+		UniversalError eo("Snapshot index beyond the end of the file");
+		eo.Append2ErrorMessage(" " + fname);
+		eo.AddEntry("Index", static_cast<double>(index));
+		eo.AddEntry("Snapshots", static_cast<double>(snapshots));
+		throw eo;
+	}
+	if (!series)
+	{
+		cells_ = static_cast<size_t>(total);
+		return;
+	}
+	// The cells of the last snapshot of a time series run to the end of the datasets
+	long long offsets[2] = { 0, static_cast<long long>(total) };
+	read_range(file_.openDataSet("offsets"), PredType::NATIVE_LLONG, k, (k + 1 < snapshots) ? 2 : 1, offsets);
+	cell_offset_ = static_cast<hsize_t>(offsets[0]);
+	edge_offset_ = cell_offset_ + k;
+	cells_ = static_cast<size_t>(offsets[1] - offsets[0]);
+}
+
+SnapshotReader::~SnapshotReader()
+{}
+
+FieldView<double> SnapshotReader::Read(Group const& group, string const& caption, hsize_t offset, size_t size,
+	size_t begin, size_t end)const
+{
+	if (begin > end || end > size)
+		throw range_error(caption, begin, end, size);
+	const size_t n = end - begin;
+	DataSet dataset = group.openDataSet(caption);
+	const hsize_t first = offset + static_cast<hsize_t>(begin);
+	if (n > 0 && MappedFile::CanMap())
+	{
+		// The address includes any user block, so it is the offset in the file
+		const haddr_t address = H5Dget_offset(dataset.getId());
+		if (dataset.getCreatePlist().getLayout() == H5D_CONTIGUOUS && address != HADDR_UNDEF &&
+			H5Tequal(dataset.getDataType().getId(), H5T_NATIVE_DOUBLE) > 0)
+		{
+			if (!map_)
+				map_.reset(new MappedFile(fname_));
+			const size_t position = static_cast<size_t>(address + first * sizeof(double));
+			if (position + n * sizeof(double) <= map_->size())
+			{
+				char const* data = map_->data() + position;
+				if (map_->IsMapped() && reinterpret_cast<size_t>(data) % sizeof(double) == 0)
+					return FieldView<double>(map_, reinterpret_cast<double const*>(data), n, true);
+				// HDF5 does not align the data, then it is copied from the map
+				boost::shared_ptr<vector<double> > copy(new vector<double>(n));
+				memcpy(&(*copy)[0], data, n * sizeof(double));
+				return FieldView<double>(copy, &(*copy)[0], n, false);
+			}
+		}
+	}
+	boost::shared_ptr<vector<double> > res(new vector<double>(n));
+	read_range(dataset, PredType::NATIVE_DOUBLE, first, static_cast<hsize_t>(n), n > 0 ? &(*res)[0] : 0);
+	return FieldView<double>(res, n > 0 ? &(*res)[0] : 0, n, false);
+}
+
+size_t SnapshotReader::GetCells() const
+{
+	return cells_;
+}
+
+double SnapshotReader::GetTime() const
+{
+	return read_entry<double>(file_, "time", PredType::NATIVE_DOUBLE, static_cast<hsize_t>(index_));
+}
+
+int SnapshotReader::GetCycle() const
+{
+	return read_entry<int>(file_, "cycle", PredType::NATIVE_INT, static_cast<hsize_t>(index_));
+}
+
+FieldView<double> SnapshotReader::GetEdges() const
+{
+	return GetEdges(0, cells_ + 1);
+}
+
+FieldView<double> SnapshotReader::GetEdges(size_t begin, size_t end) const
+{
+	return Read(geometry_, "edges", edge_offset_, cells_ + 1, begin, end);
+}
+
+FieldView<double> SnapshotReader::GetDensity() const
+{
+	return GetDensity(0, cells_);
+}
+
+FieldView<double> SnapshotReader::GetDensity(size_t begin, size_t end) const
+{
+	return Read(hydrodynamic_, "density", cell_offset_, cells_, begin, end);
+}
+
+FieldView<double> SnapshotReader::GetPressure() const
+{
+	return GetPressure(0, cells_);
+}
+
+FieldView<double> SnapshotReader::GetPressure(size_t begin, size_t end) const
+{
+	return Read(hydrodynamic_, "pressure", cell_offset_, cells_, begin, end);
+}
+
+FieldView<double> SnapshotReader::GetVelocity() const
+{
+	return GetVelocity(0, cells_);
+}
+
+FieldView<double> SnapshotReader::GetVelocity(size_t begin, size_t end) const
+{
+	return Read(hydrodynamic_, "velocity", cell_offset_, cells_, begin, end);
+}
+
+void SnapshotReader::FindCells(double inner, double outer, size_t & begin, size_t & end) const
+{
+	const FieldView<double> edges = GetEdges();
+	if (edges.size() < 2)
+	{
+		begin = 0;
+		end = 0;
+		return;
+	}
+	begin = static_cast<size_t>(upper_bound(edges.begin() + 1, edges.end(), inner) - (edges.begin() + 1));
+	end = static_cast<size_t>(lower_bound(edges.begin(), edges.end() - 1, outer) - edges.begin());
+	end = max(begin, end);
+}
@@ -0,0 +1,143 @@
+#ifndef SNAPSHOTREADER_HPP
+#define SNAPSHOTREADER_HPP 1
+
+#include <H5Cpp.h>
+#include <boost/shared_ptr.hpp>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+class MappedFile;
+
+/*! \brief Read only access to a range of a field
+\details Points either into a memory mapped file or into storage the view owns. Copies share the data, which
+stays valid as long as any view on it exists, even after the reader that made it is gone.
+*/
+template<class T> class FieldView
+{
+private:
+	boost::shared_ptr<void const> owner_;
+	T const* data_;
+	size_t size_;
+	bool mapped_;
+
+public:
+	FieldView(void):owner_(),data_(0),size_(0),mapped_(false) {}
+
+	/*!
+	\param owner Keeps the data alive
+	\param data The first element
+	\param size Number of elements
+	\param mapped Whether data points into a mapped file
+	*/
+	FieldView(boost::shared_ptr<void const> const& owner, T const* data, size_t size, bool mapped):
+		owner_(owner),data_(data),size_(size),mapped_(mapped) {}
+
+	size_t size()const
+	{
+		return size_;
+	}
+
+	bool empty()const
+	{
+		return size_ == 0;
+	}
+
+	T const& operator[](size_t index)const
+	{
+		return data_[index];
+	}
+
+	T const* begin()const
+	{
+		return data_;
+	}
+
+	T const* end()const
+	{
+		return data_ + size_;
+	}
+
+	//! \brief Whether the view reads the file through a memory map, without a copy
+	bool IsMapped()const
+	{
+		return mapped_;
+	}
+};
+
+/*! \brief Reads the fields of a snapshot one at a time, and only the cells asked for
+\details Opening reads nothing but the sizes. Each field is read on request, whole or for a range of cells,
+with a hyperslab selection. Datasets that are stored contiguously without filters, which
+write_snapshot_to_hdf5 does with a deflate level of 0, are memory mapped and the views point into the map, so
+nothing is copied. Files written by TimeSeriesWriter are read one snapshot at a time, with ranges relative to it.
+Like all HDF5 calls, the reader must not be used by two threads at once, the views it returns may.
+*/
+class SnapshotReader
+{
+private:
+	string fname_;
+	H5::H5File file_;
+	H5::Group geometry_;
+	H5::Group hydrodynamic_;
+	size_t index_;
+	size_t cells_;
+	hsize_t cell_offset_;
+	hsize_t edge_offset_;
+	mutable boost::shared_ptr<MappedFile> map_;
+
+	//! \brief Entries [begin,end) of a field with size entries that starts at offset in its dataset
+	FieldView<double> Read(H5::Group const& group, string const& caption, hsize_t offset, size_t size,
+		size_t begin, size_t end)const;
+
+	SnapshotReader(SnapshotReader const&);
+
+	SnapshotReader& operator=(SnapshotReader const&);
+
+public:
+	/*! \brief Opens a snapshot
+	\param fname File name
+	\param index Index of the snapshot in a time series, must be zero for a single snapshot
+	*/
+	explicit SnapshotReader(string const& fname, size_t index = 0);
+
+	~SnapshotReader();
+
+	//! \brief Number of cells
+	size_t GetCells()const;
+
+	double GetTime()const;
+
+	int GetCycle()const;
+
+	//! \brief All the edges, one more than cells
+	FieldView<double> GetEdges()const;
+
+	//! \brief The edges [begin,end)
+	FieldView<double> GetEdges(size_t begin, size_t end)const;
+
+	FieldView<double> GetDensity()const;
+
+	//! \brief The densities of the cells [begin,end)
+	FieldView<double> GetDensity(size_t begin, size_t end)const;
+
+	FieldView<double> GetPressure()const;
+
+	//! \brief The pressures of the cells [begin,end)
+	FieldView<double> GetPressure(size_t begin, size_t end)const;
+
+	FieldView<double> GetVelocity()const;
+
+	//! \brief The velocities of the cells [begin,end)
+	FieldView<double> GetVelocity(size_t begin, size_t end)const;
+
+	/*! \brief Finds the cells between two radii, from the edges
+	\param inner Inner radius
+	\param outer Outer radius
+	\param begin Set to the first cell whose outer edge is beyond inner
+	\param end Set to one past the last cell whose inner edge is below outer
+	*/
+	void FindCells(double inner, double outer, size_t &begin, size_t &end)const;
+};
+
+#endif //SNAPSHOTREADER_HPP
@@ -0,0 +1,174 @@
+#include "SnapshotWriter.hpp"
+#include "hdf_util.hpp"
+#include "universal_error.hpp"
+#include <exception>
+
+SnapshotWriter::Slot::Slot():cells(),edges(),time(0),cycle(0),fname(),series(0)
+{}
+
+SnapshotWriter::SnapshotWriter(size_t slots, SnapshotCompression const& compression):compression_(compression),
+	slots_(max(slots, static_cast<size_t>(1))),free_(),pending_(),
+	writing_(false),stop_(false),stalls_(0),error_(),failures_(0),mutex_(),slot_freed_(),slot_filled_(),thread_()
+{
+	for (size_t i = 0; i < slots_.size(); ++i)
+		free_.push_back(i);
+	thread_ = std::thread(&SnapshotWriter::Run, this);
+}
+
+SnapshotWriter::~SnapshotWriter()
+{
+	{
+		std::lock_guard<std::mutex> lock(mutex_);
+		stop_ = true;
+	}
+	slot_filled_.notify_one();
+	thread_.join();
+}
+
+void SnapshotWriter::Run()
+{
+	std::unique_lock<std::mutex> lock(mutex_);
+	for (;;)
+	{
+		while (pending_.empty() && !stop_)
+			slot_filled_.wait(lock);
+		if (pending_.empty())
+			return;
+		const size_t index = pending_.front();
+		pending_.pop_front();
+		writing_ = true;
+		Slot const& slot = slots_[index];
+		// The slot is not touched by Write until it is freed, so it is read without the lock
+		lock.unlock();
+		// Anything thrown here would end the program, so the first error and the number of failures are kept for
+		// the next call on the main thread
+		const string target = slot.series ? string("time series") : slot.fname;
+		string error;
+		try
+		{
+			if (slot.series)
+				slot.series->Append(slot.cells, slot.edges, slot.time, slot.cycle);
+			else
+				write_snapshot_to_hdf5(slot.cells, slot.edges, slot.time, slot.cycle, slot.fname, compression_);
+		}
+		catch (H5::Exception const& eo)
+		{
+			error = target + ": " + eo.getDetailMsg();
+		}
+		catch (UniversalError const& eo)
+		{
+			error = target + ": " + eo.GetErrorMessage();
+		}
+		catch (std::exception const& eo)
+		{
+			error = target + ": " + eo.what();
+		}
+		lock.lock();
+		if (!error.empty())
+		{
+			if (failures_ == 0)
+				error_ = error;
+			++failures_;
+		}
+		writing_ = false;
+		free_.push_back(index);
+		slot_freed_.notify_all();
+	}
+}
+
+size_t SnapshotWriter::Acquire(std::unique_lock<std::mutex> &lock)
+{
+	CheckError();
+	if (free_.empty())
+	{
+		++stalls_;
+		while (free_.empty())
+			slot_freed_.wait(lock);
+	}
+	const size_t res = free_.front();
+	free_.pop_front();
+	return res;
+}
+
+void SnapshotWriter::CheckError()
+{
+	if (failures_ == 0)
+		return;
+	UniversalError eo("Snapshot could not be written");
+	eo.Append2ErrorMessage(" " + error_);
+	if (failures_ > 1)
+		eo.AddEntry("Later snapshots that could not be written", static_cast<double>(failures_ - 1));
+	error_.clear();
+	failures_ = 0;
+	throw eo;
+}
+
+void SnapshotWriter::Queue(hdsim const & sim, DomainDecomposition const* domain, string const & fname,
+	TimeSeriesWriter * series)
+{
+	const bool gather = domain && domain->GetSize() > 1;
+	if (gather && !domain->IsFirst())
+	{
+		PrimitiveArrays cells;
+		vector<double> edges;
+		domain->Gather(sim.GetCellArrays(), sim.GetEdges(), cells, edges);
+		return;
+	}
+	size_t index = 0;
+	{
+		std::unique_lock<std::mutex> lock(mutex_);
+		index = Acquire(lock);
+	}
+	// Assignment reuses the storage of the slot
+	Slot &slot = slots_[index];
+	if (gather)
+		domain->Gather(sim.GetCellArrays(), sim.GetEdges(), slot.cells, slot.edges);
+	else
+	{
+		slot.cells = sim.GetCellArrays();
+		slot.edges = sim.GetEdges();
+	}
+	slot.time = sim.GetTime();
+	slot.cycle = sim.GetCycle();
+	slot.fname = fname;
+	slot.series = series;
+	{
+		std::lock_guard<std::mutex> lock(mutex_);
+		pending_.push_back(index);
+	}
+	slot_filled_.notify_one();
+}
+
+void SnapshotWriter::Write(hdsim const & sim, string const & fname)
+{
+	Queue(sim, 0, fname, 0);
+}
+
+void SnapshotWriter::Write(hdsim const & sim, DomainDecomposition const & domain, string const & fname)
+{
+	Queue(sim, &domain, fname, 0);
+}
+
+void SnapshotWriter::Write(hdsim const & sim, TimeSeriesWriter & series)
+{
+	Queue(sim, 0, string(), &series);
+}
+
+void SnapshotWriter::Write(hdsim const & sim, DomainDecomposition const & domain, TimeSeriesWriter & series)
+{
+	Queue(sim, &domain, string(), &series);
+}
+
+void SnapshotWriter::Flush()
+{
+	std::unique_lock<std::mutex> lock(mutex_);
+	while (!pending_.empty() || writing_)
+		slot_freed_.wait(lock);
+	CheckError();
+}
+
+size_t SnapshotWriter::GetStalls() const
+{
+	std::lock_guard<std::mutex> lock(mutex_);
+	return stalls_;
+}
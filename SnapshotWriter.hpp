@@ -0,0 +1,115 @@
+#ifndef SNAPSHOTWRITER_HPP
+#define SNAPSHOTWRITER_HPP 1
+
+#include "hdsim.hpp"
+#include "TimeSeriesWriter.hpp"
+#include "hdf_util.hpp"
+#include <string>
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+
+/*! \brief Writes snapshots to HDF5 files on a background thread
+\details Write copies the edges and cells into a free slot and returns, the encoding, compression and file output
+happen on the writer's thread. The slots are allocated once and reused, so a steady run does not allocate. When
+all slots wait to be written, Write blocks until one is free, so memory stays bounded when the disk is slow. The
+writer's thread is the only one that calls HDF5, so one writer can be shared by simulations on several threads.
+A failed write is reported by the next call to Write or Flush, with the message of the first failure since the
+last report and the number of later ones.
+*/
+class SnapshotWriter
+{
+private:
+	//! \brief A snapshot waiting to be written
+	struct Slot
+	{
+		PrimitiveArrays cells;
+		vector<double> edges;
+		double time;
+		size_t cycle;
+		string fname;
+		//! \brief Appended to instead of writing a file when set
+		TimeSeriesWriter *series;
+
+		Slot();
+	};
+
+	SnapshotCompression compression_;
+	vector<Slot> slots_;
+	deque<size_t> free_;
+	deque<size_t> pending_;
+	bool writing_;
+	bool stop_;
+	size_t stalls_;
+	//! \brief Message of the first failed write since the last report
+	string error_;
+	//! \brief Number of failed writes since the last report
+	size_t failures_;
+	mutable std::mutex mutex_;
+	std::condition_variable slot_freed_;
+	std::condition_variable slot_filled_;
+	std::thread thread_;
+
+	void Run();
+
+	//! \brief Waits for a free slot, must hold the lock
+	size_t Acquire(std::unique_lock<std::mutex> &lock);
+
+	//! \brief Copies a snapshot into a slot and queues it, gathers it on the first process of a decomposition
+	void Queue(hdsim const& sim, DomainDecomposition const* domain, string const& fname, TimeSeriesWriter *series);
+
+	//! \brief Throws the stored error with the number of failures, must hold the lock
+	void CheckError();
+
+	SnapshotWriter(SnapshotWriter const&);
+
+	SnapshotWriter& operator=(SnapshotWriter const&);
+
+public:
+	/*! \brief Starts the writer's thread
+	\param slots Number of snapshots that can wait to be written, two double buffer the output
+	\param compression Compression of the datasets of the snapshot files, not of time series
+	*/
+	explicit SnapshotWriter(size_t slots = 2, SnapshotCompression const& compression = SnapshotCompression());
+
+	//! \brief Writes the remaining snapshots and stops the thread, errors are dropped
+	~SnapshotWriter();
+
+	/*! \brief Queues a snapshot of a simulation
+	\param sim The simulation
+	\param fname The name of the output file
+	*/
+	void Write(hdsim const& sim, string const& fname);
+
+	/*! \brief Queues a snapshot of a decomposed simulation
+	\details Collects the mesh on the first process, which queues it. Every process must call it.
+	\param sim The local part of the simulation
+	\param domain The decomposition
+	\param fname The name of the output file
+	*/
+	void Write(hdsim const& sim, DomainDecomposition const& domain, string const& fname);
+
+	/*! \brief Queues a snapshot to be appended to a time series
+	\details The time series is only used by the writer's thread, it must not be destroyed before a Flush
+	\param sim The simulation
+	\param series The time series
+	*/
+	void Write(hdsim const& sim, TimeSeriesWriter &series);
+
+	/*! \brief Queues a snapshot of a decomposed simulation to be appended to a time series
+	\details Every process must call it, only the series of the first process is written
+	\param sim The local part of the simulation
+	\param domain The decomposition
+	\param series The time series
+	*/
+	void Write(hdsim const& sim, DomainDecomposition const& domain, TimeSeriesWriter &series);
+
+	//! \brief Returns once every queued snapshot is on disk
+	void Flush();
+
+	//! \brief Number of calls to Write that waited for a free slot
+	size_t GetStalls()const;
+};
+
+#endif //SNAPSHOTWRITER_HPP
@@ -1,5 +1,27 @@
 #include "SourceTerm.hpp"
 
+void SourceTerm::Prepare(vector<double> const& /*edges*/, ExtensiveArrays const& /*extensives*/,
+	double /*time*/) const
+{}
+
+void SourceTerm::CalcForce(vector<double> const & edges, PrimitiveArrays const & cells, double time,
+	ExtensiveArrays & extensives, double dt) const
+{
+	Prepare(edges, extensives, time);
+	CalcForce(edges, cells, time, extensives, dt, 0, cells.size());
+}
+
+void SourceTerm::Remesh(vector<pair<size_t, size_t> > const& /*sources*/) const
+{}
+
+void SourceTerm::GetState(vector<double> &state) const
+{
+	state.clear();
+}
+
+void SourceTerm::SetState(vector<double> const& /*state*/) const
+{}
+
 SourceTerm::~SourceTerm()
 {
 }
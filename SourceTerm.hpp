@@ -1,8 +1,7 @@
 #ifndef SOURCETERM_HPP
 #define SOURCETERM_HPP 1
 
-#include "Primitive.hpp"
-#include "Extensive.hpp"
+#include "StateArrays.hpp"
 #include <vector>
 
 using namespace std;
@@ -10,17 +9,57 @@ using namespace std;
 class SourceTerm
 {
 public:
-	virtual void CalcForce(vector<double> const& edges, vector<Primitive> const& cells, double time,
-		vector<Extensive> &extensives,double dt)const=0;
+	/*! \brief Called once before the force is applied to the blocks of a step
+	\param edges The edges
+	\param extensives The extensives at the start of the step, the masses do not change during it
+	\param time The time
+	*/
+	virtual void Prepare(vector<double> const& edges, ExtensiveArrays const& extensives, double time)const;
+
+	/*! \brief Applies the force to the cells in [begin,end)
+	\details May read all the edges and cells, but only reads and writes the extensives in its range. Blocks
+	of the same step can run concurrently after a single call to Prepare.
+	\param edges The edges
+	\param cells The cells
+	\param time The time
+	\param extensives The extensives
+	\param dt The time step
+	\param begin Index of the first cell
+	\param end One past the index of the last cell
+	*/
+	virtual void CalcForce(vector<double> const& edges, PrimitiveArrays const& cells, double time,
+		ExtensiveArrays &extensives, double dt, size_t begin, size_t end)const=0;
+
+	//! \brief Prepares and applies the force to all cells
+	void CalcForce(vector<double> const& edges, PrimitiveArrays const& cells, double time,
+		ExtensiveArrays &extensives,double dt)const;
+
+	/*! \brief Called after cells were split or merged, for source terms that keep data per cell
+	\param sources For each new cell, the old cells [first,second) it was made from. Both halves of a split cell
+	have the same range.
+	*/
+	virtual void Remesh(vector<pair<size_t, size_t> > const& sources)const;
+
+	/*! \brief Saves the data a source term keeps between steps, for checkpoints
+	\param state Set to the data, empty for source terms without any
+	*/
+	virtual void GetState(vector<double> &state)const;
+
+	/*! \brief Restores the data saved by GetState when a simulation restarts from a checkpoint
+	\param state The data
+	*/
+	virtual void SetState(vector<double> const& state)const;
 
 	virtual ~SourceTerm();
 };
 
 
-class ZeroForce : public SourceTerm
+//! \brief No force, final so that the engine can drop the call
+class ZeroForce final : public SourceTerm
 {
-  void CalcForce(vector<double> const& /*edges*/, vector<Primitive> const& /*cells*/, double /*time*/,
-		 vector<Extensive> & /*extensives*/,double /*dt*/)const
+public:
+  void CalcForce(vector<double> const& /*edges*/, PrimitiveArrays const& /*cells*/, double /*time*/,
+		 ExtensiveArrays & /*extensives*/,double /*dt*/, size_t /*begin*/, size_t /*end*/)const
 	{
 		return;
 	}
@@ -0,0 +1,67 @@
+#include "StateArrays.hpp"
+
+PrimitiveArrays::PrimitiveArrays():density(),pressure(),velocity(),entropy()
+{}
+
+PrimitiveArrays::PrimitiveArrays(vector<Primitive> const & cells):density(cells.size()),pressure(cells.size()),
+	velocity(cells.size()),entropy(cells.size())
+{
+	size_t N = cells.size();
+	for (size_t i = 0; i < N; ++i)
+		Set(i, cells[i]);
+}
+
+void PrimitiveArrays::resize(size_t N)
+{
+	density.resize(N);
+	pressure.resize(N);
+	velocity.resize(N);
+	entropy.resize(N);
+}
+
+void PrimitiveArrays::ToPrimitives(vector<Primitive>& res) const
+{
+	size_t N = size();
+	res.resize(N);
+	for (size_t i = 0; i < N; ++i)
+	{
+		res[i].density = density[i];
+		res[i].pressure = pressure[i];
+		res[i].velocity = velocity[i];
+		res[i].entropy = entropy[i];
+	}
+}
+
+void PrimitiveArrays::swap(PrimitiveArrays& other)
+{
+	density.swap(other.density);
+	pressure.swap(other.pressure);
+	velocity.swap(other.velocity);
+	entropy.swap(other.entropy);
+}
+
+ExtensiveArrays::ExtensiveArrays():mass(),momentum(),energy()
+{}
+
+void ExtensiveArrays::resize(size_t N)
+{
+	mass.resize(N);
+	momentum.resize(N);
+	energy.resize(N);
+}
+
+Extensive ExtensiveArrays::operator[](size_t index) const
+{
+	Extensive res;
+	res.mass = mass[index];
+	res.momentum = momentum[index];
+	res.energy = energy[index];
+	return res;
+}
+
+void ExtensiveArrays::swap(ExtensiveArrays& other)
+{
+	mass.swap(other.mass);
+	momentum.swap(other.momentum);
+	energy.swap(other.energy);
+}
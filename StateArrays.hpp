@@ -0,0 +1,73 @@
+#ifndef STATEARRAYS_HPP
+#define STATEARRAYS_HPP 1
+
+#include "Primitive.hpp"
+#include "Extensive.hpp"
+#include <vector>
+
+using namespace std;
+
+//! \brief Structure of arrays storage for the primitive variables of all cells
+class PrimitiveArrays
+{
+public:
+	vector<double> density;
+	vector<double> pressure;
+	vector<double> velocity;
+	vector<double> entropy;
+
+	PrimitiveArrays();
+
+	explicit PrimitiveArrays(vector<Primitive> const& cells);
+
+	size_t size()const
+	{
+		return density.size();
+	}
+
+	void resize(size_t N);
+
+	//! \brief Gathers a single cell
+	Primitive operator[](size_t index)const
+	{
+		return Primitive(density[index], pressure[index], velocity[index], entropy[index]);
+	}
+
+	//! \brief Scatters a single cell
+	void Set(size_t index, Primitive const& cell)
+	{
+		density[index] = cell.density;
+		pressure[index] = cell.pressure;
+		velocity[index] = cell.velocity;
+		entropy[index] = cell.entropy;
+	}
+
+	//! \brief Converts to array of structures
+	void ToPrimitives(vector<Primitive> &res)const;
+
+	void swap(PrimitiveArrays &other);
+};
+
+//! \brief Structure of arrays storage for the conserved variables of all cells
+class ExtensiveArrays
+{
+public:
+	vector<double> mass;
+	vector<double> momentum;
+	vector<double> energy;
+
+	ExtensiveArrays();
+
+	size_t size()const
+	{
+		return mass.size();
+	}
+
+	void resize(size_t N);
+
+	Extensive operator[](size_t index)const;
+
+	void swap(ExtensiveArrays &other);
+};
+
+#endif //STATEARRAYS_HPP
@@ -0,0 +1,191 @@
+#include "TabulatedEOS.hpp"
+#include "universal_error.hpp"
+#include <cmath>
+#include <algorithm>
+
+namespace
+{
+	// Cell of a coordinate in grid units and the offset within it, outside the grid the edge cell is used
+	void Locate(double u, size_t n, size_t &i, double &t)
+	{
+		const double cell = std::max(0.0, std::min(floor(u), static_cast<double>(n - 2)));
+		i = static_cast<size_t>(cell);
+		t = u - cell;
+	}
+
+	void CheckThermalEnergy(double e)
+	{
+		if (e < 0)
+			throw UniversalError("Negative thermal energy");
+	}
+
+	void CheckSoundSpeed(double d, double p)
+	{
+		if (d < 0 || p < 0)
+		{
+			UniversalError eo("Imaginary Cs");
+			eo.AddEntry("Density", d);
+			eo.AddEntry("Pressure", p);
+			throw eo;
+		}
+	}
+
+	void CheckPressure(double s, double d)
+	{
+		if (d < 0 || s < 0)
+		{
+			UniversalError eo("Imaginary pressure");
+			eo.AddEntry("Density", d);
+			eo.AddEntry("Entropy", s);
+			throw eo;
+		}
+	}
+
+	double Step(double vmin, double vmax, size_t n)
+	{
+		if (n < 2 || !(vmin > 0) || !(vmax > vmin))
+			throw UniversalError("Bad table range");
+		return (log(vmax) - log(vmin)) / static_cast<double>(n - 1);
+	}
+}
+
+LogTable::LogTable(double xmin, double xmax, size_t nx, double ymin, double ymax, size_t ny):
+	x0_(log(xmin)),dx_(Step(xmin, xmax, nx)),nx_(nx),y0_(log(ymin)),dy_(Step(ymin, ymax, ny)),ny_(ny),
+	values_(nx*ny, 0)
+{}
+
+double LogTable::GetX(size_t i) const
+{
+	return exp(x0_ + static_cast<double>(i)*dx_);
+}
+
+double LogTable::GetY(size_t j) const
+{
+	return exp(y0_ + static_cast<double>(j)*dy_);
+}
+
+void LogTable::Set(size_t i, size_t j, double value)
+{
+	if (!(value > 0))
+	{
+		UniversalError eo("Non positive value in table");
+		eo.AddEntry("First argument", GetX(i));
+		eo.AddEntry("Second argument", GetY(j));
+		eo.AddEntry("Value", value);
+		throw eo;
+	}
+	values_[i*ny_ + j] = log(value);
+}
+
+double LogTable::operator()(double x, double y) const
+{
+	double res = 0;
+	Interpolate(&x, &y, &res, 1);
+	return res;
+}
+
+void LogTable::Interpolate(double const* x, double const* y, double *res, size_t n) const
+{
+	double const* v = &values_[0];
+	for (size_t k = 0; k < n; ++k)
+	{
+		size_t i, j;
+		double tx, ty;
+		Locate((log(x[k]) - x0_) / dx_, nx_, i, tx);
+		Locate((log(y[k]) - y0_) / dy_, ny_, j, ty);
+		double const* row = v + i*ny_ + j;
+		double const* next_row = row + ny_;
+		const double lower = row[0] + ty*(row[1] - row[0]);
+		const double upper = next_row[0] + ty*(next_row[1] - next_row[0]);
+		res[k] = exp(lower + tx*(upper - lower));
+	}
+}
+
+TabulatedEOS::TabulatedEOS(EquationOfState const& source, double dmin, double dmax, double pmin, double pmax,
+	size_t n):
+	energy_(dmin, dmax, n, pmin, pmax, n),sound_speed_(dmin, dmax, n, pmin, pmax, n),
+	entropy_(dmin, dmax, n, pmin, pmax, n),
+	// The inverse tables cover the energies and entropies of the corners of the density and pressure grid
+	pressure_from_energy_(dmin, dmax, n, min(source.dp2e(dmax, pmin), source.dp2e(dmin, pmin)),
+		max(source.dp2e(dmin, pmax), source.dp2e(dmax, pmax)), n),
+	pressure_from_entropy_(dmin, dmax, n, min(source.dp2s(dmax, pmin), source.dp2s(dmin, pmin)),
+		max(source.dp2s(dmin, pmax), source.dp2s(dmax, pmax)), n)
+{
+	for (size_t i = 0; i < n; ++i)
+	{
+		const double d = energy_.GetX(i);
+		for (size_t j = 0; j < n; ++j)
+		{
+			const double p = energy_.GetY(j);
+			energy_.Set(i, j, source.dp2e(d, p));
+			sound_speed_.Set(i, j, source.dp2c(d, p));
+			entropy_.Set(i, j, source.dp2s(d, p));
+			pressure_from_energy_.Set(i, j, source.de2p(d, pressure_from_energy_.GetY(j)));
+			pressure_from_entropy_.Set(i, j, source.sd2p(pressure_from_entropy_.GetY(j), d));
+		}
+	}
+}
+
+double TabulatedEOS::dp2e(double d, double p) const
+{
+	return energy_(d, p);
+}
+
+double TabulatedEOS::de2p(double d, double e) const
+{
+	CheckThermalEnergy(e);
+	return pressure_from_energy_(d, e);
+}
+
+double TabulatedEOS::dp2c(double d, double p) const
+{
+	CheckSoundSpeed(d, p);
+	return sound_speed_(d, p);
+}
+
+double TabulatedEOS::de2c(double d, double e) const
+{
+	return dp2c(d, de2p(d, e));
+}
+
+double TabulatedEOS::dp2s(double d, double p) const
+{
+	return entropy_(d, p);
+}
+
+double TabulatedEOS::sd2p(double s, double d) const
+{
+	CheckPressure(s, d);
+	return pressure_from_entropy_(d, s);
+}
+
+void TabulatedEOS::dp2e(double const* d, double const* p, double *e, size_t n) const
+{
+	energy_.Interpolate(d, p, e, n);
+}
+
+void TabulatedEOS::de2p(double const* d, double const* e, double *p, size_t n) const
+{
+	for (size_t i = 0; i < n; ++i)
+		CheckThermalEnergy(e[i]);
+	pressure_from_energy_.Interpolate(d, e, p, n);
+}
+
+void TabulatedEOS::dp2c(double const* d, double const* p, double *c, size_t n) const
+{
+	for (size_t i = 0; i < n; ++i)
+		CheckSoundSpeed(d[i], p[i]);
+	sound_speed_.Interpolate(d, p, c, n);
+}
+
+void TabulatedEOS::dp2s(double const* d, double const* p, double *s, size_t n) const
+{
+	entropy_.Interpolate(d, p, s, n);
+}
+
+void TabulatedEOS::sd2p(double const* s, double const* d, double *p, size_t n) const
+{
+	for (size_t i = 0; i < n; ++i)
+		CheckPressure(s[i], d[i]);
+	pressure_from_entropy_.Interpolate(d, s, p, n);
+}
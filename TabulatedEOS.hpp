@@ -0,0 +1,108 @@
+#ifndef TABULATEDEOS_HPP
+#define TABULATEDEOS_HPP 1
+
+#include "EquationOfState.hpp"
+#include <vector>
+
+using namespace std;
+
+/*! \brief The logarithm of a positive quantity on a grid that is uniform in the logarithms of its two arguments
+\details Stored row by row with the first argument as the slow index. Lookups find their cell by arithmetic
+instead of a search and interpolate bilinearly in log space. Arguments outside the grid extrapolate from the
+nearest cell.
+*/
+class LogTable
+{
+private:
+	double x0_;
+	double dx_;
+	size_t nx_;
+	double y0_;
+	double dy_;
+	size_t ny_;
+	vector<double> values_;
+
+public:
+	/*!
+	\param xmin Smallest value of the first argument
+	\param xmax Largest value of the first argument
+	\param nx Number of grid points of the first argument, at least two
+	\param ymin Smallest value of the second argument
+	\param ymax Largest value of the second argument
+	\param ny Number of grid points of the second argument, at least two
+	*/
+	LogTable(double xmin, double xmax, size_t nx, double ymin, double ymax, size_t ny);
+
+	//! \brief Value of the first argument at grid point i
+	double GetX(size_t i)const;
+
+	//! \brief Value of the second argument at grid point j
+	double GetY(size_t j)const;
+
+	//! \brief Sets the quantity at grid point (i,j), must be positive
+	void Set(size_t i, size_t j, double value);
+
+	//! \brief Interpolated quantity
+	double operator()(double x, double y)const;
+
+	/*! \brief Interpolates n values
+	\param x First arguments
+	\param y Second arguments
+	\param res Receives the quantities
+	\param n Number of values
+	*/
+	void Interpolate(double const* x, double const* y, double *res, size_t n)const;
+};
+
+/*! \brief Equation of state interpolated from tables of another one
+\details The source equation of state, typically an expensive one, is sampled on a density and pressure grid
+for the energy, sound speed and entropy, and on matching density and energy and density and entropy grids for
+the inverse relations. All tabulated quantities must be positive. Power laws such as the ideal gas are linear in
+log space and so are reproduced to round off. The batched calls do the whole lookup in one loop, and
+neighbouring cells of a smooth profile read neighbouring rows of the tables.
+*/
+class TabulatedEOS : public EquationOfState
+{
+private:
+	LogTable energy_;
+	LogTable sound_speed_;
+	LogTable entropy_;
+	LogTable pressure_from_energy_;
+	LogTable pressure_from_entropy_;
+
+public:
+	/*! \brief Samples an equation of state
+	\param source The equation of state to tabulate
+	\param dmin Smallest density
+	\param dmax Largest density
+	\param pmin Smallest pressure
+	\param pmax Largest pressure
+	\param n Number of grid points of each argument
+	*/
+	TabulatedEOS(EquationOfState const& source, double dmin, double dmax, double pmin, double pmax,
+		size_t n = 128);
+
+	double dp2e(double d, double p)const;
+
+	double de2p(double d, double e)const;
+
+	double dp2c(double d, double p)const;
+
+	double de2c(double d, double e)const;
+
+	double dp2s(double d, double p)const;
+
+	double sd2p(double s, double d)const;
+
+	void dp2e(double const* d, double const* p, double *e, size_t n)const;
+
+	void de2p(double const* d, double const* e, double *p, size_t n)const;
+
+	void dp2c(double const* d, double const* p, double *c, size_t n)const;
+
+	void dp2s(double const* d, double const* p, double *s, size_t n)const;
+
+	void sd2p(double const* s, double const* d, double *p, size_t n)const;
+};
+
+#endif //TABULATEDEOS_HPP
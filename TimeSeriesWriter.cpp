@@ -0,0 +1,99 @@
+#include "TimeSeriesWriter.hpp"
+
+using namespace H5;
+
+namespace
+{
+	DataSet create_series(CommonFG const& file, string const& caption, DataType const& datatype, hsize_t chunk,
+		bool compress)
+	{
+		hsize_t dims[1] = { 0 };
+		hsize_t maxdims[1] = { H5S_UNLIMITED };
+		DataSpace dataspace(1, dims, maxdims);
+		DSetCreatPropList plist;
+		plist.setChunk(1, &chunk);
+		if (compress)
+			plist.setDeflate(6);
+		return file.createDataSet(H5std_string(caption), datatype, dataspace, plist);
+	}
+
+	// Extends a series from size entries and writes n more at its end
+	void append_series(DataSet &dataset, void const* data, hsize_t size, hsize_t n, DataType const& memtype)
+	{
+		hsize_t new_size[1] = { size + n };
+		dataset.extend(new_size);
+		if (n == 0)
+			return;
+		DataSpace filespace = dataset.getSpace();
+		hsize_t start[1] = { size };
+		hsize_t count[1] = { n };
+		filespace.selectHyperslab(H5S_SELECT_SET, count, start);
+		DataSpace memspace(1, count);
+		dataset.write(data, memtype, memspace, filespace);
+	}
+}
+
+TimeSeriesWriter::TimeSeriesWriter(string const & fname, size_t flush_interval, size_t chunk):fname_(fname),
+	flush_interval_(flush_interval),chunk_(static_cast<hsize_t>(max(chunk, static_cast<size_t>(1)))),file_(),time_(),
+	cycle_(),offsets_(),edges_(),density_(),pressure_(),velocity_(),snapshots_(0),cells_(0),unflushed_(0)
+{}
+
+void TimeSeriesWriter::Create()
+{
+	file_ = H5File(H5std_string(fname_), H5F_ACC_TRUNC);
+	Group geometry = file_.createGroup("/geometry");
+	Group hydrodynamic = file_.createGroup("/hydrodynamic");
+	FloatType double_type(PredType::NATIVE_DOUBLE);
+	double_type.setOrder(H5T_ORDER_LE);
+	IntType int_type(PredType::NATIVE_INT);
+	int_type.setOrder(H5T_ORDER_LE);
+	IntType offset_type(PredType::NATIVE_LLONG);
+	offset_type.setOrder(H5T_ORDER_LE);
+	// The per snapshot series grow by one entry at a time, so their chunks are small and not compressed
+	const hsize_t small_chunk = 256;
+	time_ = create_series(file_, "time", double_type, small_chunk, false);
+	cycle_ = create_series(file_, "cycle", int_type, small_chunk, false);
+	offsets_ = create_series(file_, "offsets", offset_type, small_chunk, false);
+	edges_ = create_series(geometry, "edges", double_type, chunk_, true);
+	density_ = create_series(hydrodynamic, "density", double_type, chunk_, true);
+	pressure_ = create_series(hydrodynamic, "pressure", double_type, chunk_, true);
+	velocity_ = create_series(hydrodynamic, "velocity", double_type, chunk_, true);
+}
+
+void TimeSeriesWriter::Append(PrimitiveArrays const & cells, vector<double> const & edges, double time,
+	size_t cycle)
+{
+	if (snapshots_ == 0)
+		Create();
+	const hsize_t k = static_cast<hsize_t>(snapshots_);
+	const hsize_t N = static_cast<hsize_t>(cells.size());
+	const hsize_t first = static_cast<hsize_t>(cells_);
+	const int cycle_value = static_cast<int>(cycle);
+	const long long offset = static_cast<long long>(cells_);
+	append_series(time_, &time, k, 1, PredType::NATIVE_DOUBLE);
+	append_series(cycle_, &cycle_value, k, 1, PredType::NATIVE_INT);
+	append_series(offsets_, &offset, k, 1, PredType::NATIVE_LLONG);
+	append_series(edges_, edges.empty() ? 0 : &edges[0], first + k, static_cast<hsize_t>(edges.size()),
+		PredType::NATIVE_DOUBLE);
+	append_series(density_, N == 0 ? 0 : &cells.density[0], first, N, PredType::NATIVE_DOUBLE);
+	append_series(pressure_, N == 0 ? 0 : &cells.pressure[0], first, N, PredType::NATIVE_DOUBLE);
+	append_series(velocity_, N == 0 ? 0 : &cells.velocity[0], first, N, PredType::NATIVE_DOUBLE);
+	++snapshots_;
+	cells_ += cells.size();
+	++unflushed_;
+	if (flush_interval_ > 0 && unflushed_ >= flush_interval_)
+		Flush();
+}
+
+void TimeSeriesWriter::Flush()
+{
+	if (snapshots_ == 0)
+		return;
+	file_.flush(H5F_SCOPE_GLOBAL);
+	unflushed_ = 0;
+}
+
+size_t TimeSeriesWriter::GetSnapshots() const
+{
+	return snapshots_;
+}
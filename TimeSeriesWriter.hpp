@@ -0,0 +1,63 @@
+#ifndef TIMESERIESWRITER_HPP
+#define TIMESERIESWRITER_HPP 1
+
+#include <H5Cpp.h>
+#include "StateArrays.hpp"
+#include <string>
+
+/*! \brief Appends snapshots to a single HDF5 file
+\details The file holds one dataset per quantity with an unlimited dimension, the snapshots follow each other in
+it. time, cycle and offsets have one entry per snapshot, offsets[k] is the index of the first cell of snapshot k
+in /hydrodynamic/density, pressure and velocity. Each snapshot has one edge more than cells, so its first edge in
+/geometry/edges is offsets[k]+k. read_time_series_snapshot in hdf_util reads any snapshot without touching the
+others. The file is created by the first Append and stays open until the writer is destroyed.
+*/
+class TimeSeriesWriter
+{
+private:
+	string fname_;
+	size_t flush_interval_;
+	hsize_t chunk_;
+	H5::H5File file_;
+	H5::DataSet time_;
+	H5::DataSet cycle_;
+	H5::DataSet offsets_;
+	H5::DataSet edges_;
+	H5::DataSet density_;
+	H5::DataSet pressure_;
+	H5::DataSet velocity_;
+	size_t snapshots_;
+	size_t cells_;
+	size_t unflushed_;
+
+	void Create();
+
+	TimeSeriesWriter(TimeSeriesWriter const&);
+
+	TimeSeriesWriter& operator=(TimeSeriesWriter const&);
+
+public:
+	/*!
+	\param fname Name of the file, replaced by the first Append
+	\param flush_interval Number of snapshots between flushes to disk, zero flushes only when the writer is
+	destroyed
+	\param chunk Number of elements in a chunk of the cell and edge datasets
+	*/
+	explicit TimeSeriesWriter(string const& fname, size_t flush_interval = 10, size_t chunk = 16384);
+
+	/*! \brief Adds a snapshot at the end of the file
+	\param cells The cells
+	\param edges The edges
+	\param time The time
+	\param cycle The cycle number
+	*/
+	void Append(PrimitiveArrays const& cells, vector<double> const& edges, double time, size_t cycle);
+
+	//! \brief Writes everything appended so far to disk
+	void Flush();
+
+	//! \brief Number of snapshots appended
+	size_t GetSnapshots()const;
+};
+
+#endif //TIMESERIESWRITER_HPP
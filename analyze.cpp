@@ -0,0 +1,332 @@
+/* Reduces every snapshot in an output directory to one row of a table: the conserved totals, the central values,
+the radii that enclose 10, 50 and 90 percent of the mass and a profile of the density in radius bins. The
+snapshots are the tide_<n>.h5 files in the order of n, followed by every snapshot of the time series tide.h5 and
+tide.<cycle>.h5 in the order of the cycle they start at. A resumed run starts a new series at the cycle of its
+checkpoint, so a snapshot whose cycle was already reduced from an earlier series is left out. A series or snapshot
+that can not be read is reported in a comment row. The files are reduced in parallel on all OpenMP threads.
+Usage: analyze [directory] [profile bins] [profile radius] [gas gamma] */
+#include "SnapshotReader.hpp"
+#include "hdf_util.hpp"
+#include "ideal_gas.hpp"
+#include "universal_error.hpp"
+#include "wall_time.hpp"
+#include <iostream>
+#include <iomanip>
+#include <cstdlib>
+#include <algorithm>
+#include <set>
+#include <dirent.h>
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+namespace
+{
+	/*! \brief A snapshot to reduce, the index is that of the tide file or of the snapshot in a time series
+	\details start is the cycle in the name of a time series, zero for tide.h5. A series that could not be read
+	has a single entry with the error.
+	*/
+	class Entry
+	{
+	public:
+		string fname;
+		size_t index;
+		bool series;
+		size_t start;
+		string error;
+
+		Entry(string const& fname_i, size_t index_i, bool series_i, size_t start_i = 0):
+			fname(fname_i), index(index_i), series(series_i), start(start_i), error() {}
+
+		//! \brief Tide files by number before time series by the cycle they start at and index
+		bool operator<(Entry const& other)const
+		{
+			if (series != other.series)
+				return !series;
+			if (series && start != other.start)
+				return start < other.start;
+			if (series && fname != other.fname)
+				return fname < other.fname;
+			return index < other.index;
+		}
+	};
+
+	// Whether name is prefix, digits and suffix, with the number set to the digits
+	bool match_name(string const& name, string const& prefix, string const& suffix, size_t &number)
+	{
+		if (name.size() <= prefix.size() + suffix.size() || name.compare(0, prefix.size(), prefix) != 0 ||
+			name.compare(name.size() - suffix.size(), suffix.size(), suffix) != 0)
+			return false;
+		const string digits = name.substr(prefix.size(), name.size() - prefix.size() - suffix.size());
+		if (digits.find_first_not_of("0123456789") != string::npos)
+			return false;
+		number = static_cast<size_t>(strtoul(digits.c_str(), 0, 10));
+		return true;
+	}
+
+	vector<Entry> list_snapshots(string const& dir)
+	{
+		DIR *d = opendir(dir.c_str());
+		if (!d)
+			throw UniversalError("Could not open directory " + dir);
+		vector<Entry> res;
+		vector<Entry> series;
+		for (dirent *e = readdir(d); e; e = readdir(d))
+		{
+			const string name = e->d_name;
+			size_t number = 0;
+			if (match_name(name, "tide_", ".h5", number))
+				res.push_back(Entry(dir + "/" + name, number, false));
+			else if (name == "tide.h5" || match_name(name, "tide.", ".h5", number))
+				series.push_back(Entry(dir + "/" + name, 0, true, number));
+		}
+		closedir(d);
+		// Counting the snapshots of a time series reads it, the other files are only opened by the threads
+		H5::Exception::dontPrint();
+		for (size_t i = 0; i < series.size(); ++i)
+		{
+			try
+			{
+				const size_t n = count_time_series_snapshots(series[i].fname);
+				for (size_t k = 0; k < n; ++k)
+					res.push_back(Entry(series[i].fname, k, true, series[i].start));
+			}
+			catch (UniversalError const& eo)
+			{
+				series[i].error = eo.GetErrorMessage();
+				res.push_back(series[i]);
+			}
+			catch (H5::Exception const& eo)
+			{
+				series[i].error = eo.getDetailMsg();
+				H5::Exception::clearErrorStack();
+				res.push_back(series[i]);
+			}
+		}
+		sort(res.begin(), res.end());
+		return res;
+	}
+
+	//! \brief The reductions of one snapshot
+	class Row
+	{
+	public:
+		double time;
+		int cycle;
+		size_t cells;
+		double mass;
+		double momentum;
+		double energy;
+		double central_density;
+		double central_pressure;
+		double central_velocity;
+		double radii[3];
+		vector<double> profile;
+		string error;
+
+		Row(void): time(0), cycle(0), cells(0), mass(0), momentum(0), energy(0), central_density(0),
+			central_pressure(0), central_velocity(0), profile(), error()
+		{
+			radii[0] = 0;
+			radii[1] = 0;
+			radii[2] = 0;
+		}
+	};
+
+	/* The cells are slabs, as in the simulation, so a cell's mass is its density times its width. The profile is
+	the mass in each of bins equal bins out to radius divided by the width of a bin. */
+	void reduce(FieldView<double> const& edges, FieldView<double> const& density, FieldView<double> const& pressure,
+		FieldView<double> const& velocity, EquationOfState const& eos, size_t bins, double radius, Row &row)
+	{
+		const size_t N = density.size();
+		row.cells = N;
+		row.profile.assign(bins, 0);
+		if (N == 0)
+			return;
+		row.central_density = density[0];
+		row.central_pressure = pressure[0];
+		row.central_velocity = velocity[0];
+		vector<double> enclosed(N + 1, 0);
+		const double bin_width = radius / static_cast<double>(bins);
+		for (size_t i = 0; i < N; ++i)
+		{
+			const double m = density[i] * (edges[i + 1] - edges[i]);
+			row.mass += m;
+			row.momentum += m*velocity[i];
+			row.energy += m*(0.5*velocity[i] * velocity[i] + eos.dp2e(density[i], pressure[i]));
+			enclosed[i + 1] = row.mass;
+			// Spread the mass over the bins the cell overlaps
+			if (bins == 0 || edges[i] >= radius)
+				continue;
+			const size_t first = static_cast<size_t>(max(edges[i], 0.0) / bin_width);
+			for (size_t b = first; b < bins && static_cast<double>(b)*bin_width < edges[i + 1]; ++b)
+			{
+				const double overlap = min(edges[i + 1], static_cast<double>(b + 1)*bin_width) -
+					max(edges[i], static_cast<double>(b)*bin_width);
+				if (overlap > 0)
+					row.profile[b] += density[i] * overlap;
+			}
+		}
+		for (size_t b = 0; b < bins; ++b)
+			row.profile[b] /= bin_width;
+		// The mass is taken to be uniform in each cell
+		const double fractions[3] = { 0.1, 0.5, 0.9 };
+		for (size_t k = 0; k < 3; ++k)
+		{
+			const double target = fractions[k] * row.mass;
+			const size_t i = static_cast<size_t>(lower_bound(enclosed.begin() + 1, enclosed.end(), target) -
+				enclosed.begin()) - 1;
+			const double m = enclosed[i + 1] - enclosed[i];
+			row.radii[k] = edges[i] + (m > 0 ? (target - enclosed[i]) / m : 0)*(edges[i + 1] - edges[i]);
+		}
+	}
+
+	//! \brief The fields of a snapshot, which stay valid after the file is closed
+	class Fields
+	{
+	public:
+		FieldView<double> edges;
+		FieldView<double> density;
+		FieldView<double> pressure;
+		FieldView<double> velocity;
+
+		Fields(void): edges(), density(), pressure(), velocity() {}
+	};
+
+	// Opens and reads a snapshot, a failure is recorded in the row so that no exception leaves a critical section
+	void read_fields(Entry const& entry, Fields &fields, Row &row)
+	{
+		// Failures are reported in the table. The thread safe library keeps this setting and the error stack per
+		// thread, and can not free a stack at exit from another thread, so both are handled here.
+		H5::Exception::dontPrint();
+		try
+		{
+			SnapshotReader reader(entry.fname, entry.series ? entry.index : 0);
+			fields.edges = reader.GetEdges();
+			fields.density = reader.GetDensity();
+			fields.pressure = reader.GetPressure();
+			fields.velocity = reader.GetVelocity();
+			row.time = reader.GetTime();
+			row.cycle = reader.GetCycle();
+		}
+		catch (UniversalError const& eo)
+		{
+			row.error = eo.GetErrorMessage();
+		}
+		catch (H5::Exception const& eo)
+		{
+			row.error = eo.getDetailMsg();
+			H5::Exception::clearErrorStack();
+		}
+	}
+
+	void print_header(size_t bins, double radius)
+	{
+		cout << "# time cycle cells mass momentum energy central_density central_pressure central_velocity " <<
+			"r10 r50 r90";
+		for (size_t b = 0; b < bins; ++b)
+			cout << " rho_" << b;
+		cout << "\n# profile of " << bins << " bins out to radius " << radius << "\n";
+	}
+
+	void print_row(Entry const& entry, Row const& row)
+	{
+		if (!entry.error.empty())
+		{
+			cout << "# " << entry.fname << " failed: " << entry.error << "\n";
+			return;
+		}
+		if (!row.error.empty())
+		{
+			cout << "# " << entry.fname;
+			if (entry.series)
+				cout << " snapshot " << entry.index;
+			cout << " failed: " << row.error << "\n";
+			return;
+		}
+		cout << setprecision(10) << row.time << ' ' << row.cycle << ' ' << row.cells << ' ' << row.mass << ' ' <<
+			row.momentum << ' ' << row.energy << ' ' << row.central_density << ' ' << row.central_pressure << ' ' <<
+			row.central_velocity << ' ' << row.radii[0] << ' ' << row.radii[1] << ' ' << row.radii[2];
+		for (size_t b = 0; b < row.profile.size(); ++b)
+			cout << ' ' << row.profile[b];
+		cout << "\n";
+	}
+}
+
+int main(int argc, char **argv)
+{
+	const string dir = argc > 1 ? argv[1] : ".";
+	const size_t bins = argc > 2 ? static_cast<size_t>(atol(argv[2])) : 20;
+	const double radius = argc > 3 ? atof(argv[3]) : 2;
+	const double gamma = argc > 4 ? atof(argv[4]) : 5.0 / 3.0;
+	const IdealGas eos(gamma);
+
+	const double start = wall_time();
+	vector<Entry> entries;
+	try
+	{
+		entries = list_snapshots(dir);
+	}
+	catch (UniversalError const& eo)
+	{
+		cerr << eo.GetErrorMessage() << endl;
+		return 1;
+	}
+	catch (H5::Exception const& eo)
+	{
+		cerr << eo.getDetailMsg() << endl;
+		return 1;
+	}
+
+	// Without the thread safe build of HDF5 only one thread may call it at a time. The reader maps uncompressed
+	// fields, and the views it returns outlive it, so only opening and reading are serialized, not the reductions.
+	hbool_t threadsafe = 0;
+	H5is_library_threadsafe(&threadsafe);
+	vector<Row> rows(entries.size());
+	const int n = static_cast<int>(entries.size());
+#pragma omp parallel for schedule(dynamic)
+	for (int j = 0; j < n; ++j)
+	{
+		Row &row = rows[static_cast<size_t>(j)];
+		if (!entries[static_cast<size_t>(j)].error.empty())
+			continue;
+		Fields fields;
+		if (threadsafe)
+			read_fields(entries[static_cast<size_t>(j)], fields, row);
+		else
+		{
+#pragma omp critical(hdf5)
+			read_fields(entries[static_cast<size_t>(j)], fields, row);
+		}
+		if (row.error.empty())
+			reduce(fields.edges, fields.density, fields.pressure, fields.velocity, eos, bins, radius, row);
+	}
+	const double elapsed = wall_time() - start;
+
+	print_header(bins, radius);
+	size_t failed = 0;
+	size_t repeated = 0;
+	set<int> series_cycles;
+	for (size_t j = 0; j < entries.size(); ++j)
+	{
+		Entry const& entry = entries[j];
+		if (entry.series && entry.error.empty() && rows[j].error.empty() &&
+			!series_cycles.insert(rows[j].cycle).second)
+		{
+			cout << "# " << entry.fname << " snapshot " << entry.index << " repeats cycle " << rows[j].cycle << "\n";
+			++repeated;
+			continue;
+		}
+		print_row(entry, rows[j]);
+		if (!entry.error.empty() || !rows[j].error.empty())
+			++failed;
+	}
+	int threads = 1;
+#ifdef _OPENMP
+	threads = omp_get_max_threads();
+#endif
+	cerr << "Snapshots = " << entries.size() << " Failed = " << failed << " Repeated = " << repeated <<
+		" Threads = " << threads <<
+		" Seconds = " << elapsed << endl;
+	return failed > 0 ? 1 : 0;
+}
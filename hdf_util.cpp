@@ -1,4 +1,8 @@
 #include "hdf_util.hpp"
+#include "SnapshotReader.hpp"
+#include "universal_error.hpp"
+#include <zlib.h>
+#include <algorithm>
 
 using namespace H5;
 
@@ -16,6 +20,119 @@ void write_std_vector_to_hdf5
 			datatype);
 }
 
+CompressionSettings::CompressionSettings(int level_i, bool shuffle_i, size_t chunk_i) :
+	level(level_i),
+	shuffle(shuffle_i),
+	chunk(chunk_i) {}
+
+SnapshotCompression::SnapshotCompression(void) :
+	edges(),
+	density(),
+	pressure(),
+	velocity() {}
+
+SnapshotCompression::SnapshotCompression(CompressionSettings const& all) :
+	edges(all),
+	density(all),
+	pressure(all),
+	velocity(all) {}
+
+namespace
+{
+	// The shuffle filter of HDF5, byte b of element i goes to b*n+i
+	void shuffle_bytes(unsigned char const* in, unsigned char *out, size_t n, size_t size)
+	{
+		for (size_t i = 0; i < n; ++i)
+			for (size_t b = 0; b < size; ++b)
+				out[b*n + i] = in[i*size + b];
+	}
+
+	/* Chunk c of data, padded with zeros to a whole chunk as HDF5 stores the last one, shuffled and deflated as
+	the filters of the dataset would. Returns false if zlib fails. */
+	bool compress_chunk(vector<double> const& data, size_t chunk, size_t c, CompressionSettings const& settings,
+		vector<unsigned char> &res)
+	{
+		const size_t bytes = chunk*sizeof(double);
+		vector<double> padded(chunk, 0);
+		const size_t begin = c*chunk;
+		const size_t n = min(chunk, data.size() - begin);
+		std::copy(data.begin() + static_cast<long>(begin), data.begin() + static_cast<long>(begin + n),
+			padded.begin());
+		vector<unsigned char> shuffled;
+		unsigned char const* source = reinterpret_cast<unsigned char const*>(&padded[0]);
+		if (settings.shuffle)
+		{
+			shuffled.resize(bytes);
+			shuffle_bytes(source, &shuffled[0], chunk, sizeof(double));
+			source = &shuffled[0];
+		}
+		uLongf size = compressBound(static_cast<uLong>(bytes));
+		res.resize(size);
+		if (compress2(&res[0], &size, source, static_cast<uLong>(bytes), settings.level) != Z_OK)
+			return false;
+		res.resize(size);
+		return true;
+	}
+}
+
+void write_std_vector_to_hdf5
+(const CommonFG& file,
+	const vector<double>& data,
+	const string& caption,
+	const CompressionSettings& settings)
+{
+	FloatType datatype(PredType::NATIVE_DOUBLE);
+	datatype.setOrder(H5T_ORDER_LE);
+	hsize_t dimsf[1];
+	dimsf[0] = static_cast<hsize_t>(data.size());
+	DataSpace dataspace(1, dimsf);
+	const size_t chunk = max(static_cast<size_t>(1), min(data.size(), settings.chunk));
+	hsize_t chunk_dims[1] = { static_cast<hsize_t>(chunk) };
+	DSetCreatPropList plist;
+	// Without filters the dataset is stored contiguously, so that readers can map it
+	const bool contiguous = settings.level <= 0 && !settings.shuffle;
+	if (!contiguous)
+		plist.setChunk(1, chunk_dims);
+	if (settings.shuffle)
+		plist.setShuffle();
+	if (settings.level > 0)
+		plist.setDeflate(settings.level);
+	DataSet dataset = file.createDataSet(H5std_string(caption), datatype, dataspace, plist);
+	if (data.empty())
+		return;
+
+	// The chunks are written as they are in memory, so they must already have the byte order of the file
+	if (settings.level <= 0 || H5Tget_order(H5T_NATIVE_DOUBLE) != H5T_ORDER_LE)
+	{
+		dataset.write(&data[0], PredType::NATIVE_DOUBLE);
+		return;
+	}
+	const size_t chunks = (data.size() + chunk - 1) / chunk;
+	vector<vector<unsigned char> > compressed(chunks);
+	const int nchunks = static_cast<int>(chunks);
+	int failed = 0;
+#pragma omp parallel for schedule(dynamic) if(nchunks > 1)
+	for (int c = 0; c < nchunks; ++c)
+		if (!compress_chunk(data, chunk, static_cast<size_t>(c), settings, compressed[static_cast<size_t>(c)]))
+		{
+#pragma omp atomic write
+			failed = 1;
+		}
+	if (failed)
+	{
+		UniversalError eo("Deflate failed");
+		eo.Append2ErrorMessage(" in dataset " + caption);
+		throw eo;
+	}
+	// HDF5 is called from this thread only
+	for (size_t c = 0; c < chunks; ++c)
+	{
+		hsize_t offset[1] = { static_cast<hsize_t>(c*chunk) };
+		if (H5Dwrite_chunk(dataset.getId(), H5P_DEFAULT, 0, offset, compressed[c].size(), &compressed[c][0]) < 0)
+			throw DataSetIException("write_std_vector_to_hdf5", "H5Dwrite_chunk failed");
+	}
+}
+
 void write_std_vector_to_hdf5
 (const CommonFG& file,
 	const vector<int>& data,
@@ -43,45 +160,31 @@ Snapshot::Snapshot(const Snapshot& source) :
 	time(source.time),
 	cycle(source.cycle) {}
 
-namespace 
+namespace
 {
-	template<class T> vector<T> read_vector_from_hdf5
-		(const CommonFG& file,
-			const string& caption,
-			const DataType& datatype)
+	Snapshot read_snapshot(SnapshotReader const& reader)
 	{
-		DataSet dataset = file.openDataSet(caption);
-		DataSpace filespace = dataset.getSpace();
-		hsize_t dims_out[2];
-		filespace.getSimpleExtentDims(dims_out, NULL);
-		const size_t NX = static_cast<size_t>(dims_out[0]);
-		vector<T> result(NX);
-		dataset.read(&result[0], datatype);
-		return result;
-	}
-
-	vector<double> read_double_vector_from_hdf5
-		(CommonFG& file, string const& caption)
-	{
-		return read_vector_from_hdf5<double>
-			(file,
-				caption,
-				PredType::NATIVE_DOUBLE);
-	}
-
-	vector<int> read_int_vector_from_hdf5
-		(const CommonFG& file,
-			const string& caption)
-	{
-		return read_vector_from_hdf5<int>
-			(file,
-				caption,
-				PredType::NATIVE_INT);
+		Snapshot res;
+		const FieldView<double> edges = reader.GetEdges();
+		res.edges.assign(edges.begin(), edges.end());
+		const FieldView<double> density = reader.GetDensity();
+		const FieldView<double> pressure = reader.GetPressure();
+		const FieldView<double> velocity = reader.GetVelocity();
+		res.cells.resize(density.size());
+		for (size_t i = 0; i < res.cells.size(); ++i)
+		{
+			res.cells[i].density = density[i];
+			res.cells[i].pressure = pressure[i];
+			res.cells[i].velocity = velocity[i];
+		}
+		res.time = reader.GetTime();
+		res.cycle = reader.GetCycle();
+		return res;
 	}
 }
 
-
-void write_snapshot_to_hdf5(hdsim const& sim, string const& fname)
+void write_snapshot_to_hdf5(PrimitiveArrays const& cells, vector<double> const& edges, double time,
+	size_t cycle, string const& fname, SnapshotCompression const& compression)
 {
 	H5File file(H5std_string(fname), H5F_ACC_TRUNC);
 	Group geometry = file.createGroup("/geometry");
@@ -90,78 +193,63 @@ void write_snapshot_to_hdf5(hdsim const& sim, string const& fname)
 	// General
 	write_std_vector_to_hdf5
 		(file,
-			vector<double>(1, sim.GetTime()),
+			vector<double>(1, time),
 			"time");
 	write_std_vector_to_hdf5
 		(file,
-		 vector<int>(1, static_cast<int>(sim.GetCycle())),
+		 vector<int>(1, static_cast<int>(cycle)),
 			"cycle");
 
 	// Geometry  
 	write_std_vector_to_hdf5
-		(geometry,sim.GetEdges(),"edges");
+		(geometry,edges,"edges",compression.edges);
 	
 	// Hydrodynamic
-	vector<Primitive> const& cells = sim.GetCells();
-	size_t N = cells.size();
-	vector<double> density(N), pressure(N), velocity(N);
-	for (size_t i = 0; i < N; ++i)
-	{
-		density[i] = cells[i].density;
-		pressure[i] = cells[i].pressure;
-		velocity[i] = cells[i].velocity;
-	}
-
 	write_std_vector_to_hdf5
-		(hydrodynamic,density,
-			"density");
+		(hydrodynamic,cells.density,
+			"density",
+			compression.density);
 	write_std_vector_to_hdf5
 		(hydrodynamic,
-			pressure,
-			"pressure");
+			cells.pressure,
+			"pressure",
+			compression.pressure);
 	write_std_vector_to_hdf5
 		(hydrodynamic,
-			velocity,
-			"velocity");
+			cells.velocity,
+			"velocity",
+			compression.velocity);
 }
 
-Snapshot read_hdf5_snapshot
-(const string &fname)
+void write_snapshot_to_hdf5(hdsim const& sim, string const& fname)
 {
-	Snapshot res;
-	H5File file(fname, H5F_ACC_RDONLY);
-	Group g_geometry = file.openGroup("geometry");
-	Group g_hydrodynamic = file.openGroup("hydrodynamic");
+	write_snapshot_to_hdf5(sim.GetCellArrays(), sim.GetEdges(), sim.GetTime(), sim.GetCycle(), fname);
+}
 
-	// Mesh points
-	res.edges = read_double_vector_from_hdf5(g_geometry, "edges");
+void write_snapshot_to_hdf5(hdsim const& sim, DomainDecomposition const& domain, string const& fname)
+{
+	PrimitiveArrays cells;
+	vector<double> edges;
+	domain.Gather(sim.GetCellArrays(), sim.GetEdges(), cells, edges);
+	if (domain.IsFirst())
+		write_snapshot_to_hdf5(cells, edges, sim.GetTime(), sim.GetCycle(), fname);
+}
 
-	// Hydrodynamic
-	{
-		const vector<double> density =
-			read_double_vector_from_hdf5(g_hydrodynamic, "density");
-		const vector<double> pressure =
-			read_double_vector_from_hdf5(g_hydrodynamic, "pressure");
-		const vector<double> velocity =
-			read_double_vector_from_hdf5(g_hydrodynamic, "velocity");
-		res.cells.resize(density.size());
-		for (size_t i = 0; i<res.cells.size(); ++i) 
-		{
-			res.cells.at(i).density = density.at(i);
-			res.cells.at(i).pressure = pressure.at(i);
-			res.cells.at(i).velocity = velocity.at(i);
-		}
-	}
+Snapshot read_hdf5_snapshot
+(const string &fname)
+{
+	return read_snapshot(SnapshotReader(fname));
+}
 
-	// Misc
-	{
-		const vector<double> time =
-			read_double_vector_from_hdf5(file, "time");
-		res.time = time.at(0);
-		const vector<int> cycle =
-			read_int_vector_from_hdf5(file, "cycle");
-		res.cycle = cycle.at(0);
-	}
-	return res;
+size_t count_time_series_snapshots(const string& fname)
+{
+	H5File file(fname, H5F_ACC_RDONLY);
+	hsize_t dims[1];
+	file.openDataSet("offsets").getSpace().getSimpleExtentDims(dims, NULL);
+	return static_cast<size_t>(dims[0]);
 }
 
+Snapshot read_time_series_snapshot(const string& fname, size_t index)
+{
+	return read_snapshot(SnapshotReader(fname, index));
+}
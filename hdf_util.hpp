@@ -55,6 +55,60 @@ void write_std_vector_to_hdf5
 	const vector<double>& data,
 	const string& caption);
 
+//! \brief How a dataset is chunked and compressed
+class CompressionSettings
+{
+public:
+	/*!
+	\param level_i Deflate level from 1 to 9, 0 stores the data without deflate. Without shuffle either, the data
+	is stored contiguously and SnapshotReader maps it instead of reading it.
+	\param shuffle_i Applies the shuffle filter before deflate
+	\param chunk_i Number of elements in a chunk
+	*/
+	explicit CompressionSettings(int level_i = 6, bool shuffle_i = false, size_t chunk_i = 100000);
+
+	//! \brief Deflate level, 0 for none
+	int level;
+
+	//! \brief Stores the bytes of equal significance of all elements together, which often deflates better
+	bool shuffle;
+
+	//! \brief Number of elements in a chunk, not used by contiguous datasets
+	size_t chunk;
+};
+
+//! \brief Compression of each dataset of a snapshot, the default is that of write_std_vector_to_hdf5
+class SnapshotCompression
+{
+public:
+	SnapshotCompression(void);
+
+	//! \param all Settings of every dataset
+	explicit SnapshotCompression(CompressionSettings const& all);
+
+	CompressionSettings edges;
+
+	CompressionSettings density;
+
+	CompressionSettings pressure;
+
+	CompressionSettings velocity;
+};
+
+/*! \brief Writes floating point data to hdf5, deflating the chunks in parallel
+\details The chunks are shuffled and deflated on all OpenMP threads and written with HDF5's direct chunk write,
+then the filters in the file describe them as if HDF5 had compressed them, so any HDF5 reader can read them
+\param file Either an actual file or a group within a file
+\param data Data to be written
+\param caption Name of dataset
+\param settings Chunk size and filters
+*/
+void write_std_vector_to_hdf5
+(const CommonFG& file,
+	const vector<double>& data,
+	const string& caption,
+	const CompressionSettings& settings);
+
 /*! \brief Writes integer data to hdf5
 \param file Either an actual file or a group within a file
 \param data Data to be written
@@ -92,12 +146,38 @@ public:
 };
 
 /*! \brief Load snapshot data into memory
+\details Reads every field, SnapshotReader reads single fields or ranges of cells
 \param fname File name
-\param mpioverride Flag for not reading mpi data when MPI is on
 \return Snapshot data
 */
 Snapshot read_hdf5_snapshot(const string& fname);
 
+/*! \brief Number of snapshots in a file written by TimeSeriesWriter
+\param fname File name
+\return Number of snapshots
+*/
+size_t count_time_series_snapshots(const string& fname);
+
+/*! \brief Loads one snapshot of a file written by TimeSeriesWriter
+\details Reads only the entries of the snapshot, found from the offsets dataset
+\param fname File name
+\param index Index of the snapshot, from zero
+\return Snapshot data
+*/
+Snapshot read_time_series_snapshot(const string& fname, size_t index);
+
+
+/*!
+\brief Writes cells and edges into an HDF5 file
+\param cells The cells
+\param edges The edges
+\param time The time
+\param cycle The cycle number
+\param fname The name of the output file
+\param compression Compression of each dataset
+*/
+void write_snapshot_to_hdf5(PrimitiveArrays const& cells, vector<double> const& edges, double time,
+	size_t cycle, string const& fname, SnapshotCompression const& compression = SnapshotCompression());
 
 /*!
 \brief Writes the simulation data into an HDF5 file
@@ -106,4 +186,13 @@ Snapshot read_hdf5_snapshot(const string& fname);
 \param appendices Additional data to be written to snapshot
 */
 void write_snapshot_to_hdf5(hdsim const& sim, string const& fname);
+
+/*!
+\brief Writes a decomposed simulation into a single HDF5 file
+\details Collects the mesh on the first process, which writes the file. Every process must call it.
+\param sim The local part of the simulation
+\param domain The decomposition
+\param fname The name of the output file
+*/
+void write_snapshot_to_hdf5(hdsim const& sim, DomainDecomposition const& domain, string const& fname);
 #endif // HDF_UTIL
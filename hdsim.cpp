@@ -1,69 +1,182 @@
 #include "hdsim.hpp"
+#include "universal_error.hpp"
 #include <algorithm>
+#include <cmath>
+#include <limits>
+#include <typeinfo>
 
 
-hdsim::hdsim(double cfl, vector<Primitive> const& cells, vector<double> const& edges, MinMod const& interp,
-	IdealGas const& eos, ExactRS const& rs,SourceTerm const& source):cfl_(cfl),cells_(cells),edges_(edges),interpolation_(interp),eos_(eos),
-	rs_(rs),time_(0),cycle_(0),extensives_(vector<Extensive>()),source_(source)
+template<class Interp, class EOS, class RS, class Source>
+hdsimT<Interp, EOS, RS, Source>::hdsimT(double cfl, vector<Primitive> const& cells, vector<double> const& edges,
+	Interp const& interp, EOS const& eos, RS const& rs, Source const& source):cfl_(cfl),cells_(cells),edges_(edges),interpolation_(interp),eos_(eos),
+	rs_(rs),time_(0),cycle_(0),extensives_(),source_(source),cells_view_(),view_dirty_(true),
+	use_rs_cache_(false),predictor_cache_(),corrector_cache_(),
+	fused_(false),window_states_(),window_res_(),next_dt_(0),next_dt_valid_(false),
+	spare_extensives_(),spare_edges_(),threads_(1),block_minima_(),domain_(0),levels_(1),cell_rungs_(),edge_rungs_(),pred_cells_(),
+	pred_edges_(),pred_extensives_(),pred_rs_(),cell_updates_(0),updates_avoided_(0),
+	refinement_(0),remesh_sources_(),spare_cells_(),trimming_(false),trim_radius_(0),
+	trim_density_(0),outflow_(),trimmed_cells_(0)
 {
 	size_t N = cells.size();
 	extensives_.resize(N);
 	for (size_t i = 0; i < N; ++i)
 	{
 		double vol = edges[i + 1] - edges[i];
-		extensives_[i].mass = cells[i].density*vol;
-		extensives_[i].momentum = extensives_[i].mass*cells[i].velocity;
-		extensives_[i].energy = 0.5*extensives_[i].momentum*extensives_[i].momentum / extensives_[i].mass +
-			eos_.dp2e(cells[i].density, cells[i].pressure)*extensives_[i].mass;
+		extensives_.mass[i] = cells[i].density*vol;
+		extensives_.momentum[i] = extensives_.mass[i]*cells[i].velocity;
+		extensives_.energy[i] = 0.5*extensives_.momentum[i]*extensives_.momentum[i] / extensives_.mass[i] +
+			eos_.dp2e(cells[i].density, cells[i].pressure)*extensives_.mass[i];
 	}
 }
 
 
-hdsim::~hdsim()
+template<class Interp, class EOS, class RS, class Source>
+hdsimT<Interp, EOS, RS, Source>::~hdsimT()
 {}
 
 namespace
 {
-	double GetTimeStep(vector<Primitive> const& cells, vector<double> const& edges, IdealGas const& eos, double cfl)
+	// The kernels below work on raw pointers into the structure of arrays storage so that the compiler
+	// can vectorize them. Each works on a contiguous block of cells or edges, blocks run concurrently.
+
+	/*! \brief Splits N items into contiguous blocks of nearly equal size
+	\param N Number of items
+	\param blocks Number of blocks
+	\param block Index of the block
+	\param begin Index of the first item in the block
+	\param end One past the index of the last item in the block
+	*/
+	void GetBlock(size_t N, size_t blocks, size_t block, size_t &begin, size_t &end)
 	{
-		double dt = (edges[1] - edges[0]) / eos.dp2c(cells[0].density, cells[0].pressure);
-		size_t N = cells.size();
-		for (size_t i = 1; i < N;++i)
-			dt = min(dt,(edges[i+1] - edges[i]) / eos.dp2c(cells[i].density, cells[i].pressure));
-		return dt*cfl;
+		begin = (N*block) / blocks;
+		end = (N*(block + 1)) / blocks;
 	}
 
-	void GetRSvalues(vector<pair<Primitive,Primitive> > const& interp_values, ExactRS const&rs,
-		vector<RSsolution> &res)
+	//! \brief Carries the first error thrown inside a parallel region to the calling thread
+	class BlockErrors
 	{
-		size_t N = interp_values.size();
-		res.resize(N);
-		for (size_t i = 0; i < N; ++i)
-			res[i] = rs.Solve(interp_values[i].first, interp_values[i].second);
+	private:
+		bool failed_;
+		UniversalError error_;
+	public:
+		BlockErrors():failed_(false),error_("")
+		{}
+
+		void Store(UniversalError const& eo)
+		{
+#pragma omp critical(hdsim_block_errors)
+			{
+				if (!failed_)
+				{
+					failed_ = true;
+					error_ = eo;
+				}
+			}
+		}
+
+		void Rethrow()const
+		{
+			if (failed_)
+				throw error_;
+		}
+	};
+
+	// Number of cells passed to the equation of state in one batched call, small enough for the scratch
+	// arrays to live on the stack
+	const size_t eos_chunk = 64;
+
+	/*! \brief Lowers dt, dmin and pmin to the smallest sound crossing time, density and pressure of a chunk of n
+	cells
+	\details The chunk is left out of dt if it has a bad cell, the caller reports it
+	\param d Densities of the chunk
+	\param p Pressures of the chunk
+	\param width Widths of the cells of the chunk
+	*/
+	template<class EOS> void AddChunkMinima(double const* d, double const* p, double const* width, EOS const& eos,
+		size_t n, double &dt, double &dmin, double &pmin)
+	{
+		double c[eos_chunk];
+		double chunk_dmin = numeric_limits<double>::infinity();
+		double chunk_pmin = chunk_dmin;
+		for (size_t j = 0; j < n; ++j)
+		{
+			chunk_dmin = min(chunk_dmin, d[j]);
+			chunk_pmin = min(chunk_pmin, p[j]);
+		}
+		dmin = min(dmin, chunk_dmin);
+		pmin = min(pmin, chunk_pmin);
+		if (chunk_dmin < 0 || chunk_pmin < 0)
+			return;
+		eos.dp2c(d, p, c, n);
+		for (size_t j = 0; j < n; ++j)
+			dt = min(dt, width[j] / c[j]);
 	}
 
-	void UpdateExtensives(vector<Extensive> &cells, vector<RSsolution> const& rs_values_,double dt)
+	//! \brief Lowers dt, dmin and pmin to the minima of the cells in [begin,end), see AddChunkMinima
+	template<class EOS> void AddBlockMinima(PrimitiveArrays const& cells, vector<double> const& edges,
+		EOS const& eos, size_t begin, size_t end, double &dt, double &dmin, double &pmin)
 	{
-		size_t N = cells.size();
-		for (size_t i = 0; i < N; ++i)
+		double const* x = &edges[0];
+		double width[eos_chunk];
+		for (size_t first = begin; first < end; first += eos_chunk)
 		{
-			cells[i].momentum -= (rs_values_[i + 1].pressure - rs_values_[i].pressure)*dt;
-			cells[i].energy -= (rs_values_[i + 1].pressure*rs_values_[i + 1].velocity - rs_values_[i].pressure*
-				rs_values_[i].velocity)*dt;
+			const size_t n = min(eos_chunk, end - first);
+			for (size_t j = 0; j < n; ++j)
+				width[j] = x[first + j + 1] - x[first + j];
+			AddChunkMinima(&cells.density[first], &cells.pressure[first], width, eos, n, dt, dmin, pmin);
 		}
 	}
 
-	void UpdateEdges(vector<double> &edges, vector<RSsolution> const& rs_values_,double dt)
+	/*! \brief Smallest sound crossing time, density and pressure of the cells in [begin,end)
+	\details An empty block gives infinities
+	*/
+	template<class EOS> void GetBlockMinima(PrimitiveArrays const& cells, vector<double> const& edges,
+		EOS const& eos, size_t begin, size_t end, double *res)
 	{
-		size_t N = edges.size();
-		for (size_t i = 0; i < N; ++i)
-			edges[i] += rs_values_[i].velocity*dt;
+		double dt = numeric_limits<double>::infinity();
+		double dmin = dt;
+		double pmin = dt;
+		AddBlockMinima(cells, edges, eos, begin, end, dt, dmin, pmin);
+		res[0] = dt;
+		res[1] = dmin;
+		res[2] = pmin;
+	}
+
+	// The update kernels read the state at the start of the step from source and write to target, which may
+	// be the same storage
+	void UpdateExtensives(ExtensiveArrays const& source, ExtensiveArrays &target, vector<RSsolution> const& rs_values_,
+		double dt, size_t begin, size_t end)
+	{
+		double const* mass_in = &source.mass[0];
+		double const* momentum_in = &source.momentum[0];
+		double const* energy_in = &source.energy[0];
+		double *mass = &target.mass[0];
+		double *momentum = &target.momentum[0];
+		double *energy = &target.energy[0];
+		RSsolution const* rs = &rs_values_[0];
+		for (size_t i = begin; i < end; ++i)
+		{
+			mass[i] = mass_in[i];
+			momentum[i] = momentum_in[i] - (rs[i + 1].pressure - rs[i].pressure)*dt;
+			energy[i] = energy_in[i] - (rs[i + 1].pressure*rs[i + 1].velocity - rs[i].pressure*rs[i].velocity)*dt;
+		}
+	}
+
+	void UpdateEdges(vector<double> const& source, vector<double> &target, vector<RSsolution> const& rs_values_,
+		double dt, size_t begin, size_t end)
+	{
+		double const* x_in = &source[0];
+		double *x = &target[0];
+		RSsolution const* rs = &rs_values_[0];
+		for (size_t i = begin; i < end; ++i)
+			x[i] = x_in[i] + rs[i].velocity*dt;
 	}
 
-	bool ShouldUseEntropy(Primitive const& cell, vector<RSsolution> const& rsvalues, size_t index)
+	bool ShouldUseEntropy(double density, double pressure, double velocity, vector<RSsolution> const& rsvalues,
+		size_t index)
 	{
-		double ek = cell.velocity*cell.velocity;
-		double et = cell.pressure / cell.density;
+		double ek = velocity*velocity;
+		double et = pressure / density;
 		if (et > 0.01*ek)
 			return false;
 		double dv = rsvalues[index + 1].velocity - rsvalues[index].velocity;
@@ -75,76 +188,1219 @@ namespace
 			return true;
 	}
 
-	void UpdateCells(vector<Extensive> &extensive, vector<double> const& edges, IdealGas const& eos,
-		vector<Primitive> &cells,vector<RSsolution> const& rsvalues)
+	/*! \brief Finds the pressure, entropy and consistent energy of the cells in [begin,end)
+	\details Needs the new density and velocity of the cells. Cells whose thermal energy is unreliable take
+	the pressure from their entropy. The cells go to the equation of state in chunks, with the entropy and the
+	energy cells of a chunk packed into separate batches.
+	*/
+	template<class EOS> void UpdateThermodynamics(ExtensiveArrays &extensive, EOS const& eos,
+		PrimitiveArrays &cells, vector<RSsolution> const& rsvalues, size_t begin, size_t end)
+	{
+		double const* mass = &extensive.mass[0];
+		double const* momentum = &extensive.momentum[0];
+		double *energy = &extensive.energy[0];
+		double const* density = &cells.density[0];
+		double *pressure = &cells.pressure[0];
+		double *entropy = &cells.entropy[0];
+		double packed_in[2][eos_chunk];
+		double packed_out[eos_chunk];
+		size_t packed_index[eos_chunk];
+		double thermal[eos_chunk];
+		bool use_entropy[eos_chunk];
+		for (size_t first = begin; first < end; first += eos_chunk)
+		{
+			const size_t n = min(eos_chunk, end - first);
+			for (size_t j = 0; j < n; ++j)
+				use_entropy[j] = ShouldUseEntropy(density[first + j], pressure[first + j],
+					cells.velocity[first + j], rsvalues, first + j);
+			size_t m = 0;
+			for (size_t j = 0; j < n; ++j)
+			{
+				if (!use_entropy[j])
+					continue;
+				packed_in[0][m] = entropy[first + j];
+				packed_in[1][m] = density[first + j];
+				packed_index[m] = first + j;
+				++m;
+			}
+			eos.sd2p(packed_in[0], packed_in[1], packed_out, m);
+			for (size_t k = 0; k < m; ++k)
+				pressure[packed_index[k]] = packed_out[k];
+			m = 0;
+			for (size_t j = 0; j < n; ++j)
+			{
+				if (use_entropy[j])
+					continue;
+				const size_t i = first + j;
+				packed_in[0][m] = density[i];
+				packed_in[1][m] = (energy[i] - 0.5*momentum[i] * momentum[i] / mass[i]) / mass[i];
+				packed_index[m] = i;
+				++m;
+			}
+			eos.de2p(packed_in[0], packed_in[1], packed_out, m);
+			for (size_t k = 0; k < m; ++k)
+				pressure[packed_index[k]] = packed_out[k];
+			eos.dp2e(density + first, pressure + first, thermal, n);
+			for (size_t j = 0; j < n; ++j)
+			{
+				const size_t i = first + j;
+				energy[i] = 0.5*momentum[i] * momentum[i] / mass[i] + mass[i] * thermal[j];
+			}
+			eos.dp2s(density + first, pressure + first, entropy + first, n);
+		}
+	}
+
+	template<class EOS> void UpdateCells(ExtensiveArrays &extensive, vector<double> const& edges, EOS const& eos,
+		PrimitiveArrays &cells,vector<RSsolution> const& rsvalues, size_t begin, size_t end)
+	{
+		double const* x = &edges[0];
+		double const* mass = &extensive.mass[0];
+		double const* momentum = &extensive.momentum[0];
+		double *density = &cells.density[0];
+		double *velocity = &cells.velocity[0];
+		for (size_t i = begin; i < end; ++i)
+		{
+			density[i] = mass[i] / (x[i + 1] - x[i]);
+			velocity[i] = momentum[i] / mass[i];
+		}
+		UpdateThermodynamics(extensive, eos, cells, rsvalues, begin, end);
+	}
+
+	// Number of interfaces the fused engine reconstructs and solves at a time
+	const size_t fused_window = 64;
+}
+
+template<class Interp, class EOS, class RS, class Source>
+double hdsimT<Interp, EOS, RS, Source>::CalcTimeStep()
+{
+	const size_t N = cells_.size();
+	const int nblocks = static_cast<int>(threads_);
+	block_minima_.resize(3 * threads_);
+#pragma omp parallel for schedule(static, 1) num_threads(nblocks) if(nblocks > 1)
+	for (int b = 0; b < nblocks; ++b)
+	{
+		size_t begin, end;
+		GetBlock(N, threads_, static_cast<size_t>(b), begin, end);
+		GetBlockMinima(cells_, edges_, eos_, begin, end, &block_minima_[3 * static_cast<size_t>(b)]);
+	}
+	double dt, dmin, pmin;
+	ReduceBlockMinima(dt, dmin, pmin);
+	// Let the equation of state report the bad cell
+	if (dmin < 0 || pmin < 0)
 	{
-		size_t N = cells.size();
 		for (size_t i = 0; i < N; ++i)
+			eos_.dp2c(cells_.density[i], cells_.pressure[i]);
+		throw UniversalError("Bad cell in another sub domain");
+	}
+	return dt*cfl_;
+}
+
+template<class Interp, class EOS, class RS, class Source>
+void hdsimT<Interp, EOS, RS, Source>::ReduceBlockMinima(double & dt, double & dmin, double & pmin) const
+{
+	// The minimum does not depend on the order, so this matches a single pass over all cells
+	dt = block_minima_[0];
+	dmin = block_minima_[1];
+	pmin = block_minima_[2];
+	for (size_t b = 1; b < threads_; ++b)
+	{
+		dt = min(dt, block_minima_[3 * b]);
+		dmin = min(dmin, block_minima_[3 * b + 1]);
+		pmin = min(pmin, block_minima_[3 * b + 2]);
+	}
+	if (domain_)
+	{
+		double values[3] = { dt, dmin, pmin };
+		domain_->MinAll(values, 3);
+		dt = values[0];
+		dmin = values[1];
+		pmin = values[2];
+	}
+}
+
+template<class Interp, class EOS, class RS, class Source>
+void hdsimT<Interp, EOS, RS, Source>::Reconstruct()
+{
+	const size_t N = edges_.size();
+	// Cells with two neighbours
+	const size_t Nbulk = (N > 3) ? N - 3 : 0;
+	interp_values_.resize(N);
+	const int nblocks = static_cast<int>(threads_);
+	BlockErrors errors;
+#pragma omp parallel for schedule(static, 1) num_threads(nblocks) if(nblocks > 1)
+	for (int b = 0; b < nblocks; ++b)
+	{
+		try
+		{
+			size_t begin, end;
+			GetBlock(Nbulk, threads_, static_cast<size_t>(b), begin, end);
+			for (size_t i = begin + 1; i < end + 1; ++i)
+				interpolation_.GetCellFaces(cells_, edges_, i, interp_values_[i].second, interp_values_[i + 1].first);
+		}
+		catch (UniversalError const& eo)
+		{
+			errors.Store(eo);
+		}
+	}
+	errors.Rethrow();
+	interpolation_.GetBoundaryFaces(cells_, edges_, left_faces_, right_faces_);
+	interp_values_[0].first = left_faces_[0];
+	interp_values_[0].second = left_faces_[1];
+	interp_values_[1].first = left_faces_[2];
+	interp_values_[N - 2].second = right_faces_[0];
+	interp_values_[N - 1].first = right_faces_[1];
+	interp_values_[N - 1].second = right_faces_[2];
+}
+
+template<class Interp, class EOS, class RS, class Source>
+void hdsimT<Interp, EOS, RS, Source>::SolveRiemann(RSCache *cache)
+{
+	const size_t N = interp_values_.size();
+	rs_values_.resize(N);
+	if (cache)
+	{
+		if (cache->size() != N)
+			cache->Reset(N);
+		cache->SetWorkspaceCount(threads_);
+	}
+	const int nblocks = static_cast<int>(threads_);
+	BlockErrors errors;
+#pragma omp parallel for schedule(static, 1) num_threads(nblocks) if(nblocks > 1)
+	for (int b = 0; b < nblocks; ++b)
+	{
+		try
 		{
-			double vol = edges[i + 1] - edges[i];
-			cells[i].density = extensive[i].mass / vol;
-			cells[i].velocity = extensive[i].momentum / extensive[i].mass;
-			if (ShouldUseEntropy(cells[i], rsvalues, i))
-				cells[i].pressure = eos.sd2p(cells[i].entropy, cells[i].density);
+			size_t begin, end;
+			GetBlock(N, threads_, static_cast<size_t>(b), begin, end);
+			if (cache)
+				cache->SolveRange(rs_, interp_values_, rs_values_, begin, end, static_cast<size_t>(b));
 			else
-				cells[i].pressure = eos.de2p(cells[i].density, (extensive[i].energy - 0.5*extensive[i].momentum*extensive[i].momentum
-					/ extensive[i].mass) / extensive[i].mass);
-			extensive[i].energy = 0.5*extensive[i].momentum*extensive[i].momentum / extensive[i].mass +
-				extensive[i].mass*eos.dp2e(cells[i].density, cells[i].pressure);
-			cells[i].entropy = eos.dp2s(cells[i].density, cells[i].pressure);
+				rs_.Solve(interp_values_, rs_values_, begin, end);
+		}
+		catch (UniversalError const& eo)
+		{
+			errors.Store(eo);
 		}
 	}
+	errors.Rethrow();
 }
-void hdsim::TimeAdvance2()
+
+template<class Interp, class EOS, class RS, class Source>
+void hdsimT<Interp, EOS, RS, Source>::AdvanceConserved(ExtensiveArrays const& source, ExtensiveArrays &target, vector<double> const& edges,
+	vector<double> &new_edges, double dt)
+{
+	const size_t N = source.size();
+	target.resize(N);
+	new_edges.resize(N + 1);
+	source_.Prepare(edges, source, time_);
+	const int nblocks = static_cast<int>(threads_);
+	BlockErrors errors;
+#pragma omp parallel for schedule(static, 1) num_threads(nblocks) if(nblocks > 1)
+	for (int b = 0; b < nblocks; ++b)
+	{
+		try
+		{
+			size_t begin, end;
+			GetBlock(N, threads_, static_cast<size_t>(b), begin, end);
+			UpdateExtensives(source, target, rs_values_, dt, begin, end);
+			source_.CalcForce(edges, cells_, time_, target, dt, begin, end);
+			// The last block also moves the outer edge
+			UpdateEdges(edges, new_edges, rs_values_, dt, begin, (end == N) ? N + 1 : end);
+		}
+		catch (UniversalError const& eo)
+		{
+			errors.Store(eo);
+		}
+	}
+	errors.Rethrow();
+}
+
+template<class Interp, class EOS, class RS, class Source>
+void hdsimT<Interp, EOS, RS, Source>::UpdatePrimitives()
+{
+	const size_t N = cells_.size();
+	const int nblocks = static_cast<int>(threads_);
+	BlockErrors errors;
+#pragma omp parallel for schedule(static, 1) num_threads(nblocks) if(nblocks > 1)
+	for (int b = 0; b < nblocks; ++b)
+	{
+		try
+		{
+			size_t begin, end;
+			GetBlock(N, threads_, static_cast<size_t>(b), begin, end);
+			UpdateCells(extensives_, edges_, eos_, cells_, rs_values_, begin, end);
+		}
+		catch (UniversalError const& eo)
+		{
+			errors.Store(eo);
+		}
+	}
+	errors.Rethrow();
+}
+
+template<class Interp, class EOS, class RS, class Source>
+void hdsimT<Interp, EOS, RS, Source>::ApplySource(double dt)
+{
+	const size_t N = cells_.size();
+	source_.Prepare(edges_, extensives_, time_);
+	const int nblocks = static_cast<int>(threads_);
+	BlockErrors errors;
+#pragma omp parallel for schedule(static, 1) num_threads(nblocks) if(nblocks > 1)
+	for (int b = 0; b < nblocks; ++b)
+	{
+		try
+		{
+			size_t begin, end;
+			GetBlock(N, threads_, static_cast<size_t>(b), begin, end);
+			source_.CalcForce(edges_, cells_, time_, extensives_, dt, begin, end);
+		}
+		catch (UniversalError const& eo)
+		{
+			errors.Store(eo);
+		}
+	}
+	errors.Rethrow();
+}
+
+template<class Interp, class EOS, class RS, class Source>
+void hdsimT<Interp, EOS, RS, Source>::FusedFluxBlock(ExtensiveArrays const& source, ExtensiveArrays &target, double dt, RSCache *cache,
+	size_t block)
+{
+	const size_t Nedges = edges_.size();
+	const size_t Ncells = Nedges - 1;
+	size_t first, last;
+	GetBlock(Nedges, threads_, block, first, last);
+	if (first == last)
+		return;
+	vector<pair<Primitive, Primitive> > &window_states = window_states_[block];
+	vector<RSsolution> &window_res = window_res_[block];
+	window_states.resize(fused_window);
+	window_res.resize(fused_window);
+	// Right face of the last reconstructed cell
+	Primitive carry = left_faces_[2];
+	if (first > 1 && first < Ncells)
+	{
+		Primitive left;
+		interpolation_.GetCellFaces(cells_, edges_, first - 1, left, carry);
+	}
+	for (size_t begin = first; begin < last; begin += fused_window)
+	{
+		const size_t end = std::min(begin + fused_window, last);
+		const size_t n = end - begin;
+		for (size_t i = begin; i < end; ++i)
+		{
+			pair<Primitive, Primitive> &state = window_states[i - begin];
+			if (i == 0)
+			{
+				state.first = left_faces_[0];
+				state.second = left_faces_[1];
+			}
+			else if (i == Nedges - 1)
+			{
+				state.first = right_faces_[1];
+				state.second = right_faces_[2];
+			}
+			else
+			{
+				state.first = carry;
+				if (i == Ncells - 1)
+					state.second = right_faces_[0];
+				else
+					interpolation_.GetCellFaces(cells_, edges_, i, state.second, carry);
+			}
+		}
+		if (cache)
+			cache->Solve(rs_, window_states, window_res, begin, n, block);
+		else
+			rs_.Solve(window_states, window_res, 0, n);
+		std::copy(window_res.begin(), window_res.begin() + static_cast<long>(n), rs_values_.begin() +
+			static_cast<long>(begin));
+		// Cells whose both interfaces are solved, the cell left of the block is done by the caller
+		UpdateExtensives(source, target, rs_values_, dt, (begin > first) ? begin - 1 : first, end - 1);
+	}
+}
+
+template<class Interp, class EOS, class RS, class Source>
+void hdsimT<Interp, EOS, RS, Source>::FusedFluxSweep(ExtensiveArrays const& source, ExtensiveArrays &target, double dt, RSCache *cache)
+{
+	const size_t Nedges = edges_.size();
+	const size_t Ncells = Nedges - 1;
+	rs_values_.resize(Nedges);
+	if (cache)
+	{
+		if (cache->size() != Nedges)
+			cache->Reset(Nedges);
+		cache->SetWorkspaceCount(threads_);
+	}
+	window_states_.resize(threads_);
+	window_res_.resize(threads_);
+	interpolation_.GetBoundaryFaces(cells_, edges_, left_faces_, right_faces_);
+	target.resize(Ncells);
+	const int nblocks = static_cast<int>(threads_);
+	BlockErrors errors;
+#pragma omp parallel for schedule(static, 1) num_threads(nblocks) if(nblocks > 1)
+	for (int b = 0; b < nblocks; ++b)
+	{
+		try
+		{
+			FusedFluxBlock(source, target, dt, cache, static_cast<size_t>(b));
+		}
+		catch (UniversalError const& eo)
+		{
+			errors.Store(eo);
+		}
+	}
+	errors.Rethrow();
+	// Cells that straddle two blocks
+	for (size_t b = 1; b < threads_; ++b)
+	{
+		size_t begin, end;
+		GetBlock(Nedges, threads_, b, begin, end);
+		if (begin > 0 && begin < end)
+			UpdateExtensives(source, target, rs_values_, dt, begin - 1, begin);
+	}
+}
+
+template<class Interp, class EOS, class RS, class Source>
+void hdsimT<Interp, EOS, RS, Source>::FusedCellBlock(double dt, bool get_time_step, size_t block)
+{
+	const size_t Ncells = cells_.size();
+	size_t begin, end;
+	GetBlock(Ncells, threads_, block, begin, end);
+	double *minima = &block_minima_[3 * block];
+	double new_dt = numeric_limits<double>::infinity();
+	double dmin = new_dt;
+	double pmin = new_dt;
+	if (begin < end)
+	{
+		double const* x_in = &edges_[0];
+		double *x = &spare_edges_[0];
+		RSsolution const* rs = &rs_values_[0];
+		double const* mass = &extensives_.mass[0];
+		double const* momentum = &extensives_.momentum[0];
+		double *density = &cells_.density[0];
+		double *velocity = &cells_.velocity[0];
+		// The left edge of the block is moved again instead of being read from the neighbouring block
+		double left = x_in[begin] + rs[begin].velocity*dt;
+		if (begin == 0)
+			x[0] = left;
+		// Each chunk of cells is moved, updated and measured while it is still in cache. The widths are kept
+		// here since the first edge of the next block is written by its own thread.
+		double width[eos_chunk];
+		for (size_t first = begin; first < end; first += eos_chunk)
+		{
+			const size_t last = min(first + eos_chunk, end);
+			for (size_t j = first; j < last; ++j)
+			{
+				const double right = x_in[j + 1] + rs[j + 1].velocity*dt;
+				x[j + 1] = right;
+				width[j - first] = right - left;
+				density[j] = mass[j] / width[j - first];
+				velocity[j] = momentum[j] / mass[j];
+				left = right;
+			}
+			UpdateThermodynamics(extensives_, eos_, cells_, rs_values_, first, last);
+			if (get_time_step)
+				AddChunkMinima(density + first, &cells_.pressure[first], width, eos_, last - first, new_dt, dmin,
+					pmin);
+		}
+	}
+	minima[0] = new_dt;
+	minima[1] = dmin;
+	minima[2] = pmin;
+}
+
+template<class Interp, class EOS, class RS, class Source>
+void hdsimT<Interp, EOS, RS, Source>::FusedCellSweep(double dt, bool get_time_step)
+{
+	spare_edges_.resize(edges_.size());
+	block_minima_.resize(3 * threads_);
+	const int nblocks = static_cast<int>(threads_);
+	BlockErrors errors;
+#pragma omp parallel for schedule(static, 1) num_threads(nblocks) if(nblocks > 1)
+	for (int b = 0; b < nblocks; ++b)
+	{
+		try
+		{
+			FusedCellBlock(dt, get_time_step, static_cast<size_t>(b));
+		}
+		catch (UniversalError const& eo)
+		{
+			errors.Store(eo);
+		}
+	}
+	errors.Rethrow();
+	edges_.swap(spare_edges_);
+	if (!get_time_step)
+	{
+		next_dt_valid_ = false;
+		return;
+	}
+	double dt_min, dmin, pmin;
+	ReduceBlockMinima(dt_min, dmin, pmin);
+	// A bad cell is left for GetTimeStep to report
+	next_dt_ = dt_min*cfl_;
+	next_dt_valid_ = dmin >= 0 && pmin >= 0;
+}
+
+template<class Interp, class EOS, class RS, class Source>
+void hdsimT<Interp, EOS, RS, Source>::TimeAdvance2Fused()
+{
+	double dt = next_dt_valid_ ? next_dt_ : CalcTimeStep();
+	next_dt_valid_ = false;
+
+	// After the predictor the spare buffers hold the state at the start of the step
+	FusedFluxSweep(extensives_, spare_extensives_, 0.5*dt, use_rs_cache_ ? &predictor_cache_ : 0);
+	extensives_.swap(spare_extensives_);
+	ApplySource(0.5*dt);
+	FusedCellSweep(0.5*dt, false);
+	time_ += 0.5*dt;
+
+	FusedFluxSweep(spare_extensives_, spare_extensives_, dt, use_rs_cache_ ? &corrector_cache_ : 0);
+	extensives_.swap(spare_extensives_);
+	edges_.swap(spare_edges_);
+	ApplySource(dt);
+	FusedCellSweep(dt, true);
+	time_ += 0.5*dt;
+	++cycle_;
+	cell_updates_ += cells_.size();
+	view_dirty_ = true;
+}
+
+template<class Interp, class EOS, class RS, class Source>
+size_t hdsimT<Interp, EOS, RS, Source>::AssignRungs(double dt)
+{
+	const size_t N = cells_.size();
+	cell_rungs_.resize(N);
+	for (size_t i = 0; i < N; ++i)
+	{
+		const double cell_dt = cfl_*(edges_[i + 1] - edges_[i]) / eos_.dp2c(cells_.density[i], cells_.pressure[i]);
+		size_t rung = 0;
+		double step = 2 * dt;
+		while (rung + 1 < levels_ && step <= cell_dt)
+		{
+			++rung;
+			step *= 2;
+		}
+		cell_rungs_[i] = rung;
+	}
+	// Neighbouring cells differ by at most one level
+	for (size_t i = 1; i < N; ++i)
+		cell_rungs_[i] = min(cell_rungs_[i], cell_rungs_[i - 1] + 1);
+	for (size_t i = N - 1; i > 0; --i)
+		cell_rungs_[i - 1] = min(cell_rungs_[i - 1], cell_rungs_[i] + 1);
+	// An interface takes the shorter step of its two cells
+	edge_rungs_.resize(N + 1);
+	edge_rungs_[0] = cell_rungs_[0];
+	edge_rungs_[N] = cell_rungs_[N - 1];
+	for (size_t i = 1; i < N; ++i)
+		edge_rungs_[i] = min(cell_rungs_[i - 1], cell_rungs_[i]);
+	return *max_element(cell_rungs_.begin(), cell_rungs_.end());
+}
+
+template<class Interp, class EOS, class RS, class Source>
+void hdsimT<Interp, EOS, RS, Source>::ReconstructRange(PrimitiveArrays const& cells, vector<double> const& edges, size_t begin, size_t end)
+{
+	// Same states as MinMod::GetInterpolatedValues, for the interfaces in [begin,end) only
+	const size_t Ncells = cells.size();
+	if (begin <= 1 || end >= Ncells)
+		interpolation_.GetBoundaryFaces(cells, edges, left_faces_, right_faces_);
+	if (begin == 0)
+		interp_values_[0].first = left_faces_[0];
+	if (end == Ncells + 1)
+		interp_values_[Ncells].second = right_faces_[2];
+	Primitive left, right;
+	for (size_t i = (begin > 0) ? begin - 1 : 0; i < min(end, Ncells); ++i)
+	{
+		if (i == 0)
+		{
+			left = left_faces_[1];
+			right = left_faces_[2];
+		}
+		else if (i == Ncells - 1)
+		{
+			left = right_faces_[0];
+			right = right_faces_[1];
+		}
+		else
+			interpolation_.GetCellFaces(cells, edges, i, left, right);
+		if (i >= begin)
+			interp_values_[i].second = left;
+		if (i + 1 < end)
+			interp_values_[i + 1].first = right;
+	}
+}
+
+template<class Interp, class EOS, class RS, class Source>
+size_t hdsimT<Interp, EOS, RS, Source>::BlockSubstep(size_t substep, size_t max_rung, double dt)
+{
+	const size_t Ncells = cells_.size();
+	const size_t Nedges = edges_.size();
+	// The steps of the interfaces and cells with a level up to due start now
+	size_t due = max_rung;
+	if (substep > 0)
+	{
+		due = 0;
+		while (((substep >> due) & 1) == 0)
+			++due;
+	}
+	size_t updates = 0;
+
+	// Brings the cells the due interfaces reconstruct from to the current time, at the first substep they all are
+	if (substep > 0)
+	{
+		size_t done = 0;
+		for (size_t begin = 0; begin < Nedges;)
+		{
+			if (edge_rungs_[begin] > due)
+			{
+				++begin;
+				continue;
+			}
+			size_t end = begin + 1;
+			while (end < Nedges && edge_rungs_[end] <= due)
+				++end;
+			const size_t first = max(done, (begin > 2) ? begin - 2 : 0);
+			const size_t last = min(end + 1, Ncells);
+			if (first < last)
+			{
+				UpdateCells(extensives_, edges_, eos_, cells_, rs_values_, first, last);
+				updates += last - first;
+				done = last;
+			}
+			begin = end;
+		}
+	}
+
+	// Predictor, the due interfaces are solved from the current state
+	for (size_t begin = 0; begin < Nedges;)
+	{
+		if (edge_rungs_[begin] > due)
+		{
+			++begin;
+			continue;
+		}
+		size_t end = begin + 1;
+		while (end < Nedges && edge_rungs_[end] <= due)
+			++end;
+		ReconstructRange(cells_, edges_, begin, end);
+		rs_.Solve(interp_values_, pred_rs_, begin, end);
+		begin = end;
+	}
+
+	// Corrector, each level is solved from the state half way through its own step. The cells are predicted with
+	// the new solutions of the due interfaces and the ones held by the others.
+	source_.Prepare(edges_, extensives_, time_);
+	for (size_t rung = 0; rung <= due; ++rung)
+	{
+		const double half = 0.5*ldexp(dt, static_cast<int>(rung));
+		for (size_t begin = 0; begin < Nedges;)
+		{
+			if (edge_rungs_[begin] != rung)
+			{
+				++begin;
+				continue;
+			}
+			size_t end = begin + 1;
+			while (end < Nedges && edge_rungs_[end] == rung)
+				++end;
+			const size_t first = (begin > 2) ? begin - 2 : 0;
+			const size_t last = min(end + 1, Ncells);
+			UpdateEdges(edges_, pred_edges_, pred_rs_, half, first, min(end + 2, Nedges));
+			UpdateExtensives(extensives_, pred_extensives_, pred_rs_, half, first, last);
+			source_.CalcForce(edges_, cells_, time_, pred_extensives_, half, first, last);
+			for (size_t i = first; i < last; ++i)
+				pred_cells_.Set(i, cells_[i]);
+			UpdateCells(pred_extensives_, pred_edges_, eos_, pred_cells_, pred_rs_, first, last);
+			ReconstructRange(pred_cells_, pred_edges_, begin, end);
+			rs_.Solve(interp_values_, rs_values_, begin, end);
+			std::copy(rs_values_.begin() + static_cast<long>(begin), rs_values_.begin() + static_cast<long>(end),
+				pred_rs_.begin() + static_cast<long>(begin));
+			begin = end;
+		}
+	}
+
+	// The source acts on each due cell over its whole step
+	for (size_t rung = 0; rung <= due; ++rung)
+	{
+		const double step = ldexp(dt, static_cast<int>(rung));
+		bool prepared = false;
+		for (size_t begin = 0; begin < Ncells;)
+		{
+			if (cell_rungs_[begin] != rung)
+			{
+				++begin;
+				continue;
+			}
+			size_t end = begin + 1;
+			while (end < Ncells && cell_rungs_[end] == rung)
+				++end;
+			if (!prepared)
+			{
+				source_.Prepare(edges_, extensives_, time_ + 0.5*step);
+				prepared = true;
+			}
+			source_.CalcForce(edges_, cells_, time_ + 0.5*step, extensives_, step, begin, end);
+			begin = end;
+		}
+	}
+
+	// Every interface acts at the rate of the solution it holds
+	UpdateExtensives(extensives_, extensives_, rs_values_, dt, 0, Ncells);
+	UpdateEdges(edges_, edges_, rs_values_, dt, 0, Nedges);
+	time_ += dt;
+	return updates;
+}
+
+template<class Interp, class EOS, class RS, class Source>
+void hdsimT<Interp, EOS, RS, Source>::TimeAdvanceBlocks()
+{
+	if (domain_ && domain_->GetSize() > 1)
+		throw UniversalError("Block time steps do not support a domain decomposition");
+	next_dt_valid_ = false;
+	const double dt = CalcTimeStep();
+	const size_t max_rung = AssignRungs(dt);
+	const size_t Ncells = cells_.size();
+	const size_t Nedges = edges_.size();
+	interp_values_.resize(Nedges);
+	rs_values_.resize(Nedges);
+	pred_rs_.resize(Nedges);
+	pred_extensives_.resize(Ncells);
+	// The boundary may read cells away from the interfaces being predicted
+	pred_cells_ = cells_;
+	pred_edges_ = edges_;
+	const size_t substeps = static_cast<size_t>(1) << max_rung;
+	size_t updates = 0;
+	for (size_t s = 0; s < substeps; ++s)
+		updates += BlockSubstep(s, max_rung, dt);
+	// Every step ends here
+	UpdatePrimitives();
+	updates += Ncells;
+	cell_updates_ += updates;
+	updates_avoided_ += Ncells*substeps - updates;
+	++cycle_;
+	view_dirty_ = true;
+}
+
+template<class Interp, class EOS, class RS, class Source>
+void hdsimT<Interp, EOS, RS, Source>::Remesh()
+{
+	if (domain_ && domain_->GetSize() > 1)
+		throw UniversalError("Refinement does not support a domain decomposition");
+	const size_t N = cells_.size();
+	remesh_sources_.clear();
+	size_t merges = 0;
+	for (size_t i = 0; i < N;)
+	{
+		if (refinement_->ShouldSplit(cells_, edges_, extensives_, i))
+		{
+			remesh_sources_.push_back(pair<size_t, size_t>(i, i + 1));
+			remesh_sources_.push_back(pair<size_t, size_t>(i, i + 1));
+			++i;
+		}
+		// Keeps enough cells for the reconstruction at the boundaries
+		else if (i + 1 < N && N - merges > 4 && refinement_->ShouldMerge(cells_, edges_, extensives_, i))
+		{
+			remesh_sources_.push_back(pair<size_t, size_t>(i, i + 2));
+			i += 2;
+			++merges;
+		}
+		else
+		{
+			remesh_sources_.push_back(pair<size_t, size_t>(i, i + 1));
+			++i;
+		}
+	}
+	const size_t M = remesh_sources_.size();
+	if (M == N && merges == 0)
+		return;
+
+	spare_extensives_.resize(M);
+	spare_cells_.resize(M);
+	spare_edges_.resize(M + 1);
+	spare_edges_[0] = edges_[0];
+	for (size_t k = 0; k < M; ++k)
+	{
+		const size_t first = remesh_sources_[k].first;
+		const size_t last = remesh_sources_[k].second;
+		spare_edges_[k + 1] = edges_[last];
+		if (last - first == 2)
+		{
+			const double mass = extensives_.mass[first] + extensives_.mass[first + 1];
+			const double momentum = extensives_.momentum[first] + extensives_.momentum[first + 1];
+			const double energy = extensives_.energy[first] + extensives_.energy[first + 1];
+			spare_extensives_.mass[k] = mass;
+			spare_extensives_.momentum[k] = momentum;
+			spare_extensives_.energy[k] = energy;
+			const double density = mass / (edges_[last] - edges_[first]);
+			const double velocity = momentum / mass;
+			const double thermal = energy / mass - 0.5*velocity*velocity;
+			if (thermal > 0)
+			{
+				const double pressure = eos_.de2p(density, thermal);
+				spare_cells_.Set(k, Primitive(density, pressure, velocity, eos_.dp2s(density, pressure)));
+			}
+			else
+			{
+				// Cold gas whose thermal energy was lost to round off keeps the entropy of its parts
+				const double entropy = (extensives_.mass[first] * cells_.entropy[first] +
+					extensives_.mass[first + 1] * cells_.entropy[first + 1]) / mass;
+				const double pressure = eos_.sd2p(entropy, density);
+				spare_cells_.Set(k, Primitive(density, pressure, velocity, entropy));
+				spare_extensives_.energy[k] = 0.5*momentum*velocity + mass*eos_.dp2e(density, pressure);
+			}
+			continue;
+		}
+		const bool split = (k + 1 < M && remesh_sources_[k + 1] == remesh_sources_[k]) ||
+			(k > 0 && remesh_sources_[k - 1] == remesh_sources_[k]);
+		const double share = split ? 0.5 : 1;
+		spare_extensives_.mass[k] = share*extensives_.mass[first];
+		spare_extensives_.momentum[k] = share*extensives_.momentum[first];
+		spare_extensives_.energy[k] = share*extensives_.energy[first];
+		spare_cells_.Set(k, cells_[first]);
+		// The left half ends at the middle of the cell
+		if (split && k + 1 < M && remesh_sources_[k + 1] == remesh_sources_[k])
+			spare_edges_[k + 1] = 0.5*(edges_[first] + edges_[last]);
+	}
+	extensives_.swap(spare_extensives_);
+	cells_.swap(spare_cells_);
+	edges_.swap(spare_edges_);
+	// The solutions of the last step belong to the old interfaces
+	rs_values_.clear();
+	source_.Remesh(remesh_sources_);
+	// Stored solutions belong to interfaces that may have moved
+	if (use_rs_cache_)
+	{
+		predictor_cache_.Reset(M + 1);
+		corrector_cache_.Reset(M + 1);
+	}
+	next_dt_valid_ = false;
+	view_dirty_ = true;
+}
+
+template<class Interp, class EOS, class RS, class Source>
+void hdsimT<Interp, EOS, RS, Source>::Trim()
 {
-	double dt = GetTimeStep(cells_,edges_,eos_,cfl_);
+	if (domain_ && domain_->GetSize() > 1)
+		throw UniversalError("Trimming does not support a domain decomposition");
+	const size_t N = cells_.size();
+	size_t M = N;
+	while (M > 4 && (edges_[M - 1] > trim_radius_ || cells_.density[M - 1] < trim_density_))
+	{
+		--M;
+		outflow_.mass += extensives_.mass[M];
+		outflow_.momentum += extensives_.momentum[M];
+		outflow_.energy += extensives_.energy[M];
+	}
+	if (M == N)
+		return;
+	trimmed_cells_ += N - M;
+	cells_.resize(M);
+	extensives_.resize(M);
+	edges_.resize(M + 1);
+	if (rs_values_.size() == N + 1)
+		rs_values_.resize(M + 1);
+	remesh_sources_.clear();
+	for (size_t i = 0; i < M; ++i)
+		remesh_sources_.push_back(pair<size_t, size_t>(i, i + 1));
+	source_.Remesh(remesh_sources_);
+	if (use_rs_cache_)
+	{
+		predictor_cache_.Reset(M + 1);
+		corrector_cache_.Reset(M + 1);
+	}
+	next_dt_valid_ = false;
+	view_dirty_ = true;
+}
 
-	interpolation_.GetInterpolatedValues(cells_, edges_, interp_values_);
-	GetRSvalues(interp_values_, rs_, rs_values_);
+template<class Interp, class EOS, class RS, class Source>
+void hdsimT<Interp, EOS, RS, Source>::TimeAdvance2()
+{
+	if (trimming_)
+		Trim();
+	if (refinement_)
+		Remesh();
+	if (levels_ > 1)
+	{
+		TimeAdvanceBlocks();
+		return;
+	}
+	if (fused_)
+	{
+		TimeAdvance2Fused();
+		return;
+	}
+	next_dt_valid_ = false;
+	double dt = CalcTimeStep();
 
-	vector<Extensive> old_extensive(extensives_);
-	vector<double> old_edges(edges_);
+	Reconstruct();
+	SolveRiemann(use_rs_cache_ ? &predictor_cache_ : 0);
 
-	UpdateExtensives(extensives_, rs_values_, 0.5*dt);
-	source_.CalcForce(edges_, cells_, time_, extensives_,0.5*dt);
-	UpdateEdges(edges_, rs_values_, 0.5*dt);
-	UpdateCells(extensives_, edges_, eos_, cells_,rs_values_);
+	// The predictor writes to the spare buffers and swaps, leaving the state at the start of the step in them
+	AdvanceConserved(extensives_, spare_extensives_, edges_, spare_edges_, 0.5*dt);
+	extensives_.swap(spare_extensives_);
+	edges_.swap(spare_edges_);
+	UpdatePrimitives();
 	time_ += 0.5*dt;
 
-	interpolation_.GetInterpolatedValues(cells_, edges_, interp_values_);
-	GetRSvalues(interp_values_, rs_, rs_values_);
+	Reconstruct();
+	SolveRiemann(use_rs_cache_ ? &corrector_cache_ : 0);
 
-	extensives_ = old_extensive;
-	edges_ = old_edges;
-	UpdateExtensives(extensives_, rs_values_, dt);
-	source_.CalcForce(edges_, cells_, time_, extensives_,dt);
-	UpdateEdges(edges_, rs_values_, dt);
-	UpdateCells(extensives_, edges_, eos_, cells_,rs_values_);
+	// The corrector updates the start of step extensives in place and moves the start of step edges over the
+	// predicted ones
+	AdvanceConserved(spare_extensives_, spare_extensives_, spare_edges_, edges_, dt);
+	extensives_.swap(spare_extensives_);
+	UpdatePrimitives();
 	time_ += 0.5*dt;
 	++cycle_;
+	cell_updates_ += cells_.size();
+	view_dirty_ = true;
 }
 
-double hdsim::GetTime() const
+template<class Interp, class EOS, class RS, class Source>
+double hdsimT<Interp, EOS, RS, Source>::GetTime() const
 {
 	return time_;
 }
 
-vector<Primitive> const & hdsim::GetCells() const
+template<class Interp, class EOS, class RS, class Source>
+vector<Primitive> const & hdsimT<Interp, EOS, RS, Source>::GetCells() const
+{
+	if (view_dirty_)
+	{
+		cells_.ToPrimitives(cells_view_);
+		view_dirty_ = false;
+	}
+	return cells_view_;
+}
+
+template<class Interp, class EOS, class RS, class Source>
+PrimitiveArrays const & hdsimT<Interp, EOS, RS, Source>::GetCellArrays() const
 {
 	return cells_;
 }
 
-vector<double> const & hdsim::GetEdges() const
+template<class Interp, class EOS, class RS, class Source>
+ExtensiveArrays const & hdsimT<Interp, EOS, RS, Source>::GetExtensives() const
+{
+	return extensives_;
+}
+
+template<class Interp, class EOS, class RS, class Source>
+vector<double> const & hdsimT<Interp, EOS, RS, Source>::GetEdges() const
 {
 	return edges_;
 }
 
-size_t hdsim::GetCycle() const
+template<class Interp, class EOS, class RS, class Source>
+size_t hdsimT<Interp, EOS, RS, Source>::GetCycle() const
 {
 	return cycle_;
 }
 
-void hdsim::SetTime(double t)
+template<class Interp, class EOS, class RS, class Source>
+void hdsimT<Interp, EOS, RS, Source>::SetTime(double t)
 {
 	time_ = t;
 }
+
+template<class Interp, class EOS, class RS, class Source>
+void hdsimT<Interp, EOS, RS, Source>::SetRiemannCache(double tolerance)
+{
+	use_rs_cache_ = tolerance > 0;
+	predictor_cache_.SetTolerance(tolerance);
+	corrector_cache_.SetTolerance(tolerance);
+}
+
+template<class Interp, class EOS, class RS, class Source>
+size_t hdsimT<Interp, EOS, RS, Source>::GetRiemannCacheHits() const
+{
+	return predictor_cache_.GetHits() + corrector_cache_.GetHits();
+}
+
+template<class Interp, class EOS, class RS, class Source>
+size_t hdsimT<Interp, EOS, RS, Source>::GetRiemannCacheMisses() const
+{
+	return predictor_cache_.GetMisses() + corrector_cache_.GetMisses();
+}
+
+template<class Interp, class EOS, class RS, class Source>
+void hdsimT<Interp, EOS, RS, Source>::SetFusedStepping(bool fused)
+{
+	fused_ = fused;
+	next_dt_valid_ = false;
+}
+
+template<class Interp, class EOS, class RS, class Source>
+void hdsimT<Interp, EOS, RS, Source>::SetThreads(size_t threads)
+{
+	threads_ = std::max(threads, static_cast<size_t>(1));
+}
+
+template<class Interp, class EOS, class RS, class Source>
+size_t hdsimT<Interp, EOS, RS, Source>::GetThreads() const
+{
+	return threads_;
+}
+
+template<class Interp, class EOS, class RS, class Source>
+void hdsimT<Interp, EOS, RS, Source>::SetDomain(DomainDecomposition const& domain)
+{
+	domain_ = &domain;
+}
+
+template<class Interp, class EOS, class RS, class Source>
+void hdsimT<Interp, EOS, RS, Source>::SetTimeStepLevels(size_t levels)
+{
+	levels_ = std::max(levels, static_cast<size_t>(1));
+}
+
+template<class Interp, class EOS, class RS, class Source>
+size_t hdsimT<Interp, EOS, RS, Source>::GetTimeStepLevels() const
+{
+	return levels_;
+}
+
+template<class Interp, class EOS, class RS, class Source>
+size_t hdsimT<Interp, EOS, RS, Source>::GetCellUpdates() const
+{
+	return cell_updates_;
+}
+
+template<class Interp, class EOS, class RS, class Source>
+size_t hdsimT<Interp, EOS, RS, Source>::GetCellUpdatesAvoided() const
+{
+	return updates_avoided_;
+}
+
+template<class Interp, class EOS, class RS, class Source>
+void hdsimT<Interp, EOS, RS, Source>::SetRefinement(RefinementCriteria const* criteria)
+{
+	refinement_ = criteria;
+}
+
+template<class Interp, class EOS, class RS, class Source>
+void hdsimT<Interp, EOS, RS, Source>::SetTrimming(double max_radius, double density_floor)
+{
+	trimming_ = true;
+	trim_radius_ = max_radius;
+	trim_density_ = density_floor;
+}
+
+template<class Interp, class EOS, class RS, class Source>
+Extensive const& hdsimT<Interp, EOS, RS, Source>::GetOutflow() const
+{
+	return outflow_;
+}
+
+template<class Interp, class EOS, class RS, class Source>
+size_t hdsimT<Interp, EOS, RS, Source>::GetTrimmedCells() const
+{
+	return trimmed_cells_;
+}
+
+template<class Interp, class EOS, class RS, class Source>
+void hdsimT<Interp, EOS, RS, Source>::GetCheckpoint(Checkpoint &res) const
+{
+	res.cells = cells_;
+	res.extensives = extensives_;
+	res.edges = edges_;
+	res.time = time_;
+	res.cycle = cycle_;
+	res.interfaces = rs_values_;
+	res.next_dt = next_dt_;
+	res.next_dt_valid = next_dt_valid_;
+	res.outflow = outflow_;
+	res.trimmed_cells = trimmed_cells_;
+	res.cell_updates = cell_updates_;
+	res.updates_avoided = updates_avoided_;
+	source_.GetState(res.source);
+}
+
+template<class Interp, class EOS, class RS, class Source>
+void hdsimT<Interp, EOS, RS, Source>::Restart(Checkpoint const& checkpoint)
+{
+	const size_t N = checkpoint.cells.size();
+	if (checkpoint.extensives.size() != N || checkpoint.edges.size() != N + 1 ||
+		(!checkpoint.interfaces.empty() && checkpoint.interfaces.size() != N + 1))
+		throw UniversalError("Checkpoint cells, extensives, edges and interfaces do not match");
+	cells_ = checkpoint.cells;
+	extensives_ = checkpoint.extensives;
+	edges_ = checkpoint.edges;
+	time_ = checkpoint.time;
+	cycle_ = checkpoint.cycle;
+	rs_values_ = checkpoint.interfaces;
+	next_dt_ = checkpoint.next_dt;
+	next_dt_valid_ = checkpoint.next_dt_valid;
+	outflow_ = checkpoint.outflow;
+	trimmed_cells_ = checkpoint.trimmed_cells;
+	cell_updates_ = checkpoint.cell_updates;
+	updates_avoided_ = checkpoint.updates_avoided;
+	source_.SetState(checkpoint.source);
+	if (use_rs_cache_)
+	{
+		predictor_cache_.Reset(N + 1);
+		corrector_cache_.Reset(N + 1);
+	}
+	view_dirty_ = true;
+}
+
+hdsimBase::~hdsimBase()
+{}
+
+// The production configurations and the fully virtual fallback
+template class hdsimT<MinMod, IdealGas, ExactRS, SourceTerm>;
+template class hdsimT<MinMod, IdealGas, ExactRS, ZeroForce>;
+template class hdsimT<MinMod, EquationOfState, RiemannSolver, SourceTerm>;
+
+namespace
+{
+	hdsimBase* CreateEngine(double cfl, vector<Primitive> const& cells, vector<double> const& edges,
+		MinMod const& interp, EquationOfState const& eos, RiemannSolver const& rs, SourceTerm const& source)
+	{
+		if (typeid(eos) == typeid(IdealGas) && typeid(rs) == typeid(ExactRS))
+		{
+			IdealGas const& ideal = static_cast<IdealGas const&>(eos);
+			ExactRS const& exact = static_cast<ExactRS const&>(rs);
+			if (typeid(source) == typeid(ZeroForce))
+				return new hdsimT<MinMod, IdealGas, ExactRS, ZeroForce>(cfl, cells, edges, interp, ideal, exact,
+					static_cast<ZeroForce const&>(source));
+			return new hdsimT<MinMod, IdealGas, ExactRS, SourceTerm>(cfl, cells, edges, interp, ideal, exact, source);
+		}
+		return new hdsimT<MinMod, EquationOfState, RiemannSolver, SourceTerm>(cfl, cells, edges, interp, eos, rs,
+			source);
+	}
+}
+
+hdsim::hdsim(double cfl, vector<Primitive> const& cells, vector<double> const& edges, MinMod const& interp,
+	EquationOfState const& eos, RiemannSolver const& rs, SourceTerm const& source):
+	engine_(CreateEngine(cfl, cells, edges, interp, eos, rs, source))
+{}
+
+hdsim::~hdsim()
+{}
+
+void hdsim::TimeAdvance2()
+{
+	engine_->TimeAdvance2();
+}
+
+double hdsim::GetTime() const
+{
+	return engine_->GetTime();
+}
+
+vector<Primitive> const& hdsim::GetCells() const
+{
+	return engine_->GetCells();
+}
+
+PrimitiveArrays const& hdsim::GetCellArrays() const
+{
+	return engine_->GetCellArrays();
+}
+
+ExtensiveArrays const& hdsim::GetExtensives() const
+{
+	return engine_->GetExtensives();
+}
+
+vector<double> const& hdsim::GetEdges() const
+{
+	return engine_->GetEdges();
+}
+
+size_t hdsim::GetCycle() const
+{
+	return engine_->GetCycle();
+}
+
+void hdsim::SetTime(double t)
+{
+	engine_->SetTime(t);
+}
+
+void hdsim::SetRiemannCache(double tolerance)
+{
+	engine_->SetRiemannCache(tolerance);
+}
+
+size_t hdsim::GetRiemannCacheHits() const
+{
+	return engine_->GetRiemannCacheHits();
+}
+
+size_t hdsim::GetRiemannCacheMisses() const
+{
+	return engine_->GetRiemannCacheMisses();
+}
+
+void hdsim::SetFusedStepping(bool fused)
+{
+	engine_->SetFusedStepping(fused);
+}
+
+void hdsim::SetThreads(size_t threads)
+{
+	engine_->SetThreads(threads);
+}
+
+size_t hdsim::GetThreads() const
+{
+	return engine_->GetThreads();
+}
+
+void hdsim::SetDomain(DomainDecomposition const& domain)
+{
+	engine_->SetDomain(domain);
+}
+
+void hdsim::SetTimeStepLevels(size_t levels)
+{
+	engine_->SetTimeStepLevels(levels);
+}
+
+size_t hdsim::GetTimeStepLevels() const
+{
+	return engine_->GetTimeStepLevels();
+}
+
+size_t hdsim::GetCellUpdates() const
+{
+	return engine_->GetCellUpdates();
+}
+
+size_t hdsim::GetCellUpdatesAvoided() const
+{
+	return engine_->GetCellUpdatesAvoided();
+}
+
+void hdsim::SetRefinement(RefinementCriteria const* criteria)
+{
+	engine_->SetRefinement(criteria);
+}
+
+void hdsim::SetTrimming(double max_radius, double density_floor)
+{
+	engine_->SetTrimming(max_radius, density_floor);
+}
+
+Extensive const& hdsim::GetOutflow() const
+{
+	return engine_->GetOutflow();
+}
+
+size_t hdsim::GetTrimmedCells() const
+{
+	return engine_->GetTrimmedCells();
+}
+
+void hdsim::GetCheckpoint(Checkpoint &res) const
+{
+	engine_->GetCheckpoint(res);
+}
+
+void hdsim::Restart(Checkpoint const& checkpoint)
+{
+	engine_->Restart(checkpoint);
+}
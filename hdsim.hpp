@@ -5,36 +5,251 @@
 #include "MinMod.hpp"
 #include "ideal_gas.hpp"
 #include "ExactRS.hpp"
-#include "Extensive.hpp"
+#include "StateArrays.hpp"
 #include "SourceTerm.hpp"
+#include "RSCache.hpp"
+#include "DomainDecomposition.hpp"
+#include "RefinementCriteria.hpp"
+#include "Extensive.hpp"
+#include "Checkpoint.hpp"
+#include <boost/scoped_ptr.hpp>
 #include <vector>
 
 using namespace std;
 
-class hdsim
+//! \brief Interface of the simulation engines, the methods are documented in hdsim
+class hdsimBase
+{
+public:
+	virtual void TimeAdvance2()=0;
+	virtual double GetTime()const=0;
+	virtual vector<Primitive>const& GetCells()const=0;
+	virtual PrimitiveArrays const& GetCellArrays()const=0;
+	virtual ExtensiveArrays const& GetExtensives()const=0;
+	virtual vector<double> const& GetEdges()const=0;
+	virtual size_t GetCycle()const=0;
+	virtual void SetTime(double t)=0;
+	virtual void SetRiemannCache(double tolerance)=0;
+	virtual size_t GetRiemannCacheHits()const=0;
+	virtual size_t GetRiemannCacheMisses()const=0;
+	virtual void SetFusedStepping(bool fused)=0;
+	virtual void SetThreads(size_t threads)=0;
+	virtual size_t GetThreads()const=0;
+	virtual void SetDomain(DomainDecomposition const& domain)=0;
+	virtual void SetTimeStepLevels(size_t levels)=0;
+	virtual size_t GetTimeStepLevels()const=0;
+	virtual size_t GetCellUpdates()const=0;
+	virtual size_t GetCellUpdatesAvoided()const=0;
+	virtual void SetRefinement(RefinementCriteria const* criteria)=0;
+	virtual void SetTrimming(double max_radius, double density_floor)=0;
+	virtual Extensive const& GetOutflow()const=0;
+	virtual size_t GetTrimmedCells()const=0;
+	virtual void GetCheckpoint(Checkpoint &res)const=0;
+	virtual void Restart(Checkpoint const& checkpoint)=0;
+	virtual ~hdsimBase();
+};
+
+/*! \brief Simulation engine whose components are policy types
+\details The interpolation, equation of state, Riemann solver and source term are called through their own
+types, so calls to final classes are direct and definitions in headers are inlined, such as the empty force of
+ZeroForce. With the abstract bases as policies every call is virtual, which works with any components. The
+boundary is a policy of the interpolation. Only the configurations instantiated in hdsim.cpp are available.
+*/
+template<class Interp, class EOS, class RS, class Source> class hdsimT : public hdsimBase
 {
 private:
 	const double cfl_;
-	vector<Primitive> cells_;
+	PrimitiveArrays cells_;
 	vector<double> edges_;
-	MinMod const& interpolation_;
-	IdealGas const& eos_;
-	ExactRS const& rs_;
+	Interp const& interpolation_;
+	EOS const& eos_;
+	RS const& rs_;
 	double time_;
 	size_t cycle_;
 	vector<pair<Primitive, Primitive> > interp_values_;
 	vector<RSsolution> rs_values_;
-	vector<Extensive> extensives_;
-	SourceTerm const& source_;
+	ExtensiveArrays extensives_;
+	Source const& source_;
+	mutable vector<Primitive> cells_view_;
+	mutable bool view_dirty_;
+	bool use_rs_cache_;
+	RSCache predictor_cache_;
+	RSCache corrector_cache_;
+	bool fused_;
+	vector<vector<pair<Primitive, Primitive> > > window_states_;
+	vector<vector<RSsolution> > window_res_;
+	Primitive left_faces_[3];
+	Primitive right_faces_[3];
+	double next_dt_;
+	bool next_dt_valid_;
+	ExtensiveArrays spare_extensives_;
+	vector<double> spare_edges_;
+	size_t threads_;
+	vector<double> block_minima_;
+	DomainDecomposition const* domain_;
+	size_t levels_;
+	vector<size_t> cell_rungs_;
+	vector<size_t> edge_rungs_;
+	PrimitiveArrays pred_cells_;
+	vector<double> pred_edges_;
+	ExtensiveArrays pred_extensives_;
+	vector<RSsolution> pred_rs_;
+	size_t cell_updates_;
+	size_t updates_avoided_;
+	RefinementCriteria const* refinement_;
+	vector<pair<size_t, size_t> > remesh_sources_;
+	PrimitiveArrays spare_cells_;
+	bool trimming_;
+	double trim_radius_;
+	double trim_density_;
+	Extensive outflow_;
+	size_t trimmed_cells_;
+
+	double CalcTimeStep();
+	void ReduceBlockMinima(double &dt, double &dmin, double &pmin)const;
+	void Reconstruct();
+	void SolveRiemann(RSCache *cache);
+	void AdvanceConserved(ExtensiveArrays const& source, ExtensiveArrays &target, vector<double> const& edges,
+		vector<double> &new_edges, double dt);
+	void UpdatePrimitives();
+	void ApplySource(double dt);
+	void FusedFluxBlock(ExtensiveArrays const& source, ExtensiveArrays &target, double dt, RSCache *cache,
+		size_t block);
+	void FusedFluxSweep(ExtensiveArrays const& source, ExtensiveArrays &target, double dt, RSCache *cache);
+	void FusedCellBlock(double dt, bool get_time_step, size_t block);
+	void FusedCellSweep(double dt, bool get_time_step);
+	void TimeAdvance2Fused();
+	size_t AssignRungs(double dt);
+	void ReconstructRange(PrimitiveArrays const& cells, vector<double> const& edges, size_t begin, size_t end);
+	size_t BlockSubstep(size_t substep, size_t max_rung, double dt);
+	void TimeAdvanceBlocks();
+	void Remesh();
+	void Trim();
+public:
+	hdsimT(double cfl, vector<Primitive> const& cells, vector<double> const& edges, Interp const& interp,
+		EOS const& eos, RS const& rs, Source const& source);
+	~hdsimT();
+	void TimeAdvance2();
+	double GetTime()const;
+	vector<Primitive>const& GetCells()const;
+	PrimitiveArrays const& GetCellArrays()const;
+	ExtensiveArrays const& GetExtensives()const;
+	vector<double> const& GetEdges()const;
+	size_t GetCycle()const;
+	void SetTime(double t);
+	void SetRiemannCache(double tolerance);
+	size_t GetRiemannCacheHits()const;
+	size_t GetRiemannCacheMisses()const;
+	void SetFusedStepping(bool fused);
+	void SetThreads(size_t threads);
+	size_t GetThreads()const;
+	void SetDomain(DomainDecomposition const& domain);
+	void SetTimeStepLevels(size_t levels);
+	size_t GetTimeStepLevels()const;
+	size_t GetCellUpdates()const;
+	size_t GetCellUpdatesAvoided()const;
+	void SetRefinement(RefinementCriteria const* criteria);
+	void SetTrimming(double max_radius, double density_floor);
+	Extensive const& GetOutflow()const;
+	size_t GetTrimmedCells()const;
+	void GetCheckpoint(Checkpoint &res)const;
+	void Restart(Checkpoint const& checkpoint);
+};
+
+/*! \brief The simulation
+\details Picks the hdsimT instantiation that matches the run time types of the components, with every
+component called through its base class when no specialized configuration matches
+*/
+class hdsim
+{
+private:
+	boost::scoped_ptr<hdsimBase> engine_;
+
 public:
 	hdsim(double cfl,vector<Primitive> const& cells,vector<double> const& edges,MinMod const& interp,
-		IdealGas const& eos,ExactRS const& rs,SourceTerm const& source);
+		EquationOfState const& eos,RiemannSolver const& rs,SourceTerm const& source);
 	~hdsim();
 	void TimeAdvance2();
 	double GetTime()const;
 	vector<Primitive>const& GetCells()const;
+	PrimitiveArrays const& GetCellArrays()const;
+	ExtensiveArrays const& GetExtensives()const;
 	vector<double> const& GetEdges()const;
 	size_t GetCycle()const;
 	void SetTime(double t);
+	/*! \brief Reuses Riemann solutions of interfaces whose states changed by less than tolerance since the last
+	solve, a non positive tolerance turns the cache off
+	*/
+	void SetRiemannCache(double tolerance);
+	size_t GetRiemannCacheHits()const;
+	size_t GetRiemannCacheMisses()const;
+	/*! \brief Selects the fused stepping engine
+	\details The fused engine reconstructs, solves and applies the fluxes in one sweep over a small window of
+	interfaces, then moves the edges and updates the cells in a second sweep that also finds the next time step.
+	Only the interface solutions are stored. The results are bitwise identical to the default engine.
+	*/
+	void SetFusedStepping(bool fused);
+	/*! \brief Sets the number of threads TimeAdvance2 uses
+	\details The mesh is split into one contiguous block of cells per thread. Every stage of the step works
+	on the blocks concurrently, and the results are bitwise identical to a single thread. Has no effect unless
+	compiled with OpenMP.
+	*/
+	void SetThreads(size_t threads);
+	size_t GetThreads()const;
+	/*! \brief Makes this the sub domain of one process in a decomposed mesh
+	\details The cells and edges given to the constructor must be the local part of the mesh and the
+	interpolation must use a DomainBoundary. The time step is then the minimum over all processes, so every
+	process must advance together.
+	*/
+	void SetDomain(DomainDecomposition const& domain);
+	/*! \brief Selects block time steps
+	\details Each cell gets the longest of the steps dt, 2dt, 4dt ... 2^(levels-1)dt that its own CFL condition
+	allows, where dt is the global step, and neighbouring cells differ by at most one level. A call to
+	TimeAdvance2 then advances the mesh by the longest step in use, and each cell and interface is advanced
+	only when its own step is due. An interface takes the shorter step of its two cells, and its solution is
+	applied to both of them, so mass, momentum and energy stay conservative between levels. The levels are
+	reassigned at the start of every TimeAdvance2. Runs on one thread, does not use the Riemann cache or the
+	fused engine, and does not support a domain decomposition over several processes or boundaries that read the
+	far end of the mesh. One or zero levels selects the global step.
+	*/
+	void SetTimeStepLevels(size_t levels);
+	size_t GetTimeStepLevels()const;
+	//! \brief Number of times a cell was advanced by one step, in either mode
+	size_t GetCellUpdates()const;
+	//! \brief Number of cell updates block time steps saved compared with advancing every cell by the global step
+	size_t GetCellUpdatesAvoided()const;
+	/*! \brief Splits and merges cells before every step
+	\details A split cell becomes two halves of equal width that share its mass, momentum and energy. Merged cells
+	add theirs up, so both are conservative. Source terms that keep data per cell are told through
+	SourceTerm::Remesh. Does not support a domain decomposition over several processes.
+	\param criteria Decides which cells split and merge, null turns refinement off
+	*/
+	void SetRefinement(RefinementCriteria const* criteria);
+	/*! \brief Removes escaped cells at the outer end of the mesh before every step
+	\details The outermost cells whose inner edge is beyond max_radius or whose density is below density_floor
+	are dropped, one after the other until a cell that should stay is found. Their mass, momentum and energy
+	are added to the outflow ledger, and the outer boundary acts on the new last cell. At least four cells are
+	kept for the reconstruction. Does not support a domain decomposition over several processes.
+	\param max_radius Cells beyond this radius are removed
+	\param density_floor Cells lighter than this are removed, zero keeps all
+	*/
+	void SetTrimming(double max_radius, double density_floor);
+	//! \brief Total mass, momentum and energy of the removed cells
+	Extensive const& GetOutflow()const;
+	//! \brief Number of cells removed by trimming
+	size_t GetTrimmedCells()const;
+	/*! \brief Saves the state of the simulation
+	\details Holds the cells, extensives, edges, time, cycle, the interface solutions of the last step, the
+	counters and the state of the source term. The user values of res are left as they are.
+	\param res The checkpoint, its storage is reused
+	*/
+	void GetCheckpoint(Checkpoint &res)const;
+	/*! \brief Continues from a checkpoint
+	\details The following steps are bitwise identical to those the saved simulation would have taken, if it
+	is set up with the same components and settings. The Riemann cache is emptied, so with a cache the steps
+	only agree to within its tolerance. With a domain decomposition each process restores its own part.
+	\param checkpoint The checkpoint
+	*/
+	void Restart(Checkpoint const& checkpoint);
 };
 #endif //HDSIM_HPP
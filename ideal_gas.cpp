@@ -2,8 +2,45 @@
 #include "ideal_gas.hpp"
 #include "universal_error.hpp"
 
+namespace
+{
+  void ThrowImaginaryCs(double d, double p)
+  {
+    UniversalError eo("Imaginary Cs");
+    eo.AddEntry("Density", d);
+    eo.AddEntry("Pressure", p);
+    throw eo;
+  }
+
+  void ThrowImaginaryPressure(double s, double d)
+  {
+    UniversalError eo("Imaginary pressure");
+    eo.AddEntry("Density", d);
+    eo.AddEntry("Entropy", s);
+    throw eo;
+  }
+
+  template<class Index> void EntropyLoop(Index const& index, double const* d, double const* p, double *s,
+					 size_t n)
+  {
+    for (size_t i = 0; i < n; ++i)
+      s[i] = p[i]*index.PowMinusGamma(d[i]);
+  }
+
+  template<class Index> void PressureLoop(Index const& index, double const* s, double const* d, double *p,
+					  size_t n)
+  {
+    for (size_t i = 0; i < n; ++i)
+      {
+	if (d[i] < 0 || s[i] < 0)
+	  ThrowImaginaryPressure(s[i], d[i]);
+	p[i] = s[i]*index.PowGamma(d[i]);
+      }
+  }
+}
+
 IdealGas::IdealGas(double AdiabaticIndex):
-  g_(AdiabaticIndex) {}
+  g_(AdiabaticIndex), index_(ClassifyIndex(AdiabaticIndex)) {}
 
 double IdealGas::getAdiabaticIndex(void) const
 {
@@ -25,12 +62,7 @@ double IdealGas::de2p(double d, double e) const
 double IdealGas::dp2c(double d, double p) const
 {
 	if (d < 0 || p < 0)
-	{
-		UniversalError eo("Imaginary Cs");
-		eo.AddEntry("Density", d);
-		eo.AddEntry("Pressure", p);
-		throw eo;
-	}
+		ThrowImaginaryCs(d, p);
   return sqrt(g_*p/d);
 }
 
@@ -42,17 +74,84 @@ double IdealGas::de2c(double d, double e) const
 
 double IdealGas::dp2s(double d, double p) const
 {
-  return p*pow(d,-g_);
+  switch (index_)
+    {
+    case five_thirds_index:
+      return p*RationalIndex<5, 3>().PowMinusGamma(d);
+    case four_thirds_index:
+      return p*RationalIndex<4, 3>().PowMinusGamma(d);
+    default:
+      return p*pow(d,-g_);
+    }
 }
 
 double IdealGas::sd2p(double s, double d) const
 {
 	if (d < 0 || s < 0)
-	{
-		UniversalError eo("Imaginary pressure");
-		eo.AddEntry("Density", d);
-		eo.AddEntry("Entropy", s);
-		throw eo;
-	}
-  return s*pow(d,g_);
+		ThrowImaginaryPressure(s, d);
+  switch (index_)
+    {
+    case five_thirds_index:
+      return s*RationalIndex<5, 3>().PowGamma(d);
+    case four_thirds_index:
+      return s*RationalIndex<4, 3>().PowGamma(d);
+    default:
+      return s*pow(d,g_);
+    }
+}
+
+void IdealGas::dp2e(double const* d, double const* p, double *e, size_t n) const
+{
+  for (size_t i = 0; i < n; ++i)
+    e[i] = p[i]/d[i]/(g_-1);
+}
+
+void IdealGas::de2p(double const* d, double const* e, double *p, size_t n) const
+{
+  for (size_t i = 0; i < n; ++i)
+    {
+      if (e[i] < 0)
+	throw UniversalError("Negative thermal energy");
+      p[i] = (g_-1)*e[i]*d[i];
+    }
+}
+
+void IdealGas::dp2c(double const* d, double const* p, double *c, size_t n) const
+{
+  for (size_t i = 0; i < n; ++i)
+    {
+      if (d[i] < 0 || p[i] < 0)
+	ThrowImaginaryCs(d[i], p[i]);
+      c[i] = sqrt(g_*p[i]/d[i]);
+    }
+}
+
+void IdealGas::dp2s(double const* d, double const* p, double *s, size_t n) const
+{
+  switch (index_)
+    {
+    case five_thirds_index:
+      EntropyLoop(RationalIndex<5, 3>(), d, p, s, n);
+      break;
+    case four_thirds_index:
+      EntropyLoop(RationalIndex<4, 3>(), d, p, s, n);
+      break;
+    default:
+      EntropyLoop(RuntimeIndex(g_), d, p, s, n);
+    }
+}
+
+void IdealGas::sd2p(double const* s, double const* d, double *p, size_t n) const
+{
+  switch (index_)
+    {
+    case five_thirds_index:
+      PressureLoop(RationalIndex<5, 3>(), s, d, p, n);
+      break;
+    case four_thirds_index:
+      PressureLoop(RationalIndex<4, 3>(), s, d, p, n);
+      break;
+    default:
+      PressureLoop(RuntimeIndex(g_), s, d, p, n);
+    }
 }
@@ -1,11 +1,19 @@
 #ifndef IDEAL_GAS_HPP
 #define IDEAL_GAS_HPP 1
 
-class IdealGas
+#include "AdiabaticIndex.hpp"
+#include "EquationOfState.hpp"
+
+/*! \brief Ideal gas equation of state
+\details Adiabatic indices of 5/3 and 4/3 compute the entropy with specializations whose powers are resolved
+at compile time. The batched calls choose the specialization once per batch.
+*/
+class IdealGas final : public EquationOfState
 {
 private:
 
   double g_;
+  IndexKind index_;
 
 public:
 
@@ -24,6 +32,16 @@ public:
   double dp2s(double d, double p) const;
 
   double sd2p(double s, double d) const;
+
+  void dp2e(double const* d, double const* p, double *e, size_t n) const;
+
+  void de2p(double const* d, double const* e, double *p, size_t n) const;
+
+  void dp2c(double const* d, double const* p, double *c, size_t n) const;
+
+  void dp2s(double const* d, double const* p, double *s, size_t n) const;
+
+  void sd2p(double const* s, double const* d, double *p, size_t n) const;
 };
 
 #endif // IDEAL_GAS_HPP
@@ -1,11 +1,24 @@
 #define _USE_MATH_DEFINES
 #include "hdsim.hpp"
 #include "hdf_util.hpp"
+#include "universal_error.hpp"
+#include "ParabolicOrbit.hpp"
+#include "SelfGravity.hpp"
+#include "SnapshotWriter.hpp"
+#include "wall_time.hpp"
 #include <iostream>
 #include <fstream>
+#include <sstream>
 #include <cassert>
-#include <boost/math/tools/roots.hpp>
+#include <boost/ptr_container/ptr_vector.hpp>
+#include <boost/scoped_ptr.hpp>
 #include <float.h>
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+#ifdef HDSIM_MPI
+#include <mpi.h>
+#endif
 #ifdef _MSC_VER // Checks if code is compiled by Micro$oft visual studio
 #include <Windows.h>
 
@@ -60,22 +73,49 @@ namespace
 		return res;
 	}
 
-	vector<Primitive> calc_init(vector<double> const& edges, double M, double R, double Nemden,double stargamma)
+	//! \brief Tabulated Lane Emden solution
+	class LaneEmden
 	{
-		// Get lane emden result, G=1 R=Rsun M=Msun
-		vector<double> xsi, theta, dtheta;
-		if (stargamma < 1.6)
-		{
-			xsi = read_vector("xsin3.txt");
-			theta = read_vector("thetan3.txt");
-			dtheta = read_vector("dthetan3.txt");
-		}
-		else
+	public:
+		vector<double> xsi;
+		vector<double> theta;
+		vector<double> dtheta;
+
+		explicit LaneEmden(string const& suffix):
+			xsi(read_vector("xsi" + suffix + ".txt")),
+			theta(read_vector("theta" + suffix + ".txt")),
+			dtheta(read_vector("dtheta" + suffix + ".txt")) {}
+	};
+
+	//! \brief Reads each Lane Emden table once, however many simulations use it
+	class LaneEmdenTables
+	{
+	private:
+		boost::ptr_vector<LaneEmden> tables_;
+		vector<string> suffixes_;
+	public:
+		LaneEmdenTables(void): tables_(), suffixes_() {}
+
+		//! \brief The n=3 table, or the one without a suffix
+		LaneEmden const& get(bool n3)
 		{
-			xsi = read_vector("xsi.txt");
-			theta = read_vector("theta.txt");
-			dtheta = read_vector("dtheta.txt");
+			const string suffix = n3 ? "n3" : "";
+			for (size_t i = 0; i < suffixes_.size(); ++i)
+				if (suffixes_[i] == suffix)
+					return tables_[i];
+			tables_.push_back(new LaneEmden(suffix));
+			suffixes_.push_back(suffix);
+			return tables_.back();
 		}
+	};
+
+	vector<Primitive> calc_init(vector<double> const& edges, double M, double R, double Nemden,
+		LaneEmden const& table)
+	{
+		// Get lane emden result, G=1 R=Rsun M=Msun
+		vector<double> const& xsi = table.xsi;
+		vector<double> const& theta = table.theta;
+		vector<double> const& dtheta = table.dtheta;
 		size_t n = xsi.size();
 		double rhoc = -M*xsi[n - 1] / (4 * M_PI*R*R*R*dtheta[n - 1]);
 		double K = M*M*pow(4 * M_PI, 1.0 / Nemden)*pow(-M*xsi[n - 1] / (dtheta[n - 1] * R*R*R), -(Nemden + 1.0) / Nemden) /
@@ -111,94 +151,60 @@ namespace
 		return res;
 	}
 
-	class ParaboleAnomaly
-	{
-	private:
-		double t_, Rp_, Mbh_;
-	public:
-		ParaboleAnomaly(double t, double Rp, double Mbh) :t_(t), Rp_(Rp), Mbh_(Mbh) {}
-		double operator()(double f)
-		{
-			return t_ - sqrt(2 * pow(Rp_, 3) / Mbh_)*tan(f / 2)*(3 + pow(tan(f / 2), 2)) / 3;
-		}
-	};
-
-	struct TerminationCondition
+	/* The black hole's pull on the cells, Mbh x/r^3 with r^2 = R^2+x^2, over raw pointers so that the loop
+	vectorizes. The self gravity of the star is added when given. */
+	void tidal_force(vector<double> const& edges, PrimitiveArrays const& cells, double const* self_acc,
+		double Mbh, double R2, ExtensiveArrays & extensives, double dt, size_t begin, size_t end)
 	{
-		bool operator() (double min, double max)
+		double const* x_edges = &edges[0];
+		double const* velocity = &cells.velocity[0];
+		double const* mass = &extensives.mass[0];
+		double *momentum = &extensives.momentum[0];
+		double *energy = &extensives.energy[0];
+		for (size_t i = begin; i < end; ++i)
 		{
-			return abs(min - max) <= 0.000001;
+			const double x = 0.5*(x_edges[i + 1] + x_edges[i]);
+			const double r2 = R2 + x*x;
+			double acc = -Mbh*x / (r2*sqrt(r2));
+			if (self_acc)
+				acc += self_acc[i];
+			momentum[i] += mass[i]*acc*dt;
+			energy[i] += mass[i]*acc*dt*velocity[i];
 		}
-	};
-
-	double GetTrueAnomaly(double t, double Rp, double Mbh)
-	{
-
-		ParaboleAnomaly Eanom(t, Rp, Mbh);
-		pair<double, double> res = boost::math::tools::bisect(Eanom, -M_PI, M_PI,
-			TerminationCondition());
-		return res.first;
 	}
 
 	class Gravity : public SourceTerm
 	{
 	private:
-		vector<double> acc_;
-		double rhoc_;
-		double alpha_;
+		SelfGravity self_;
 		double Mbh_;
-		double Rp_;
-		mutable double f_;
+		ParabolicOrbit orbit_;
+		mutable double R2_;
 		bool selfgravity_;
 	public:
-		Gravity(double M, double R, double Mbh, double Rp,bool selfgravity,double stargamma, vector<double> const& edges) :
-			acc_(vector<double>()),rhoc_(0),alpha_(0), Mbh_(Mbh), Rp_(Rp), f_(0),selfgravity_(selfgravity)
+		Gravity(double Mbh, double Rp, bool selfgravity, DomainDecomposition const& domain) :
+			self_(), Mbh_(Mbh), orbit_(Rp, Mbh), R2_(0), selfgravity_(selfgravity)
 		{
-			vector<double> xi, dtheta;
-			if (stargamma > 1.6)
-			{
-				xi = read_vector("xsi.txt");
-				dtheta = read_vector("dtheta.txt");
-			}
-			else
-			{
-				xi = read_vector("xsin3.txt");
-				dtheta = read_vector("dthetan3.txt");
-			}
-			size_t n = xi.size();
-			rhoc_ = -M*xi[n - 1] / (4 * M_PI*R*R*R*dtheta[n - 1]);
-			alpha_ = R / xi[n - 1];
+			self_.SetDomain(domain);
+		}
 
-			size_t N = edges.size()-1;
-			acc_.resize(N);
-			for (size_t i = 0; i < N; ++i)
-			{
-				double x = 0.5*(edges[i + 1] + edges[i]);
-				double xsi = x / alpha_;
-				if (xsi > xi.back())
-					xsi = xi.back() - 0.000001;
-				double Mtemp = -rhoc_*alpha_*alpha_*alpha_ * 4 * M_PI*LinearInterpolation(xi, dtheta, xsi)*xsi*xsi;
-				acc_[i] = -Mtemp / (x*x);
-			}
+		using SourceTerm::CalcForce;
+
+		// The enclosed mass is summed from the current cells, so nothing per cell is kept between steps
+		void Prepare(vector<double> const& edges, ExtensiveArrays const& extensives, double time)const
+		{
+			if (selfgravity_)
+				self_.Prepare(edges, extensives, time);
+			const double R = orbit_.GetDistance(time);
+			R2_ = R*R;
 		}
 
-		void CalcForce(vector<double> const& edges, vector<Primitive> const& cells, double time,
-			vector<Extensive> & extensives, double dt)const
+		void CalcForce(vector<double> const& edges, PrimitiveArrays const& cells, double /*time*/,
+			ExtensiveArrays & extensives, double dt, size_t begin, size_t end)const
 		{
-			size_t N = cells.size();
-			f_ = GetTrueAnomaly(time, Rp_, Mbh_);
-			for (size_t i = 0; i < N; ++i)
-			{
-				double acc = acc_[i];
-				if (!selfgravity_)
-					acc = 0;
-				// Do Mbh
-				double R = 2 * Rp_ / (1 + cos(f_));
-				double x = 0.5*(edges[i + 1] + edges[i]);
-				acc -= Mbh_*x*pow(sqrt(R*R + x*x), -3);
-				extensives[i].momentum += extensives[i].mass*acc*dt;
-				extensives[i].energy += extensives[i].mass*acc*dt*cells[i].velocity;
-			}
+			// The branch on self_acc is the same for all cells and is taken out of the loop by the compiler
+			tidal_force(edges, cells, selfgravity_ ? &self_.GetAcceleration()[0] : 0, Mbh_, R2_, extensives, dt,
+				begin, end);
 		}
 	};
 
@@ -266,12 +272,13 @@ namespace
   class SimData
   {
   public:
-    SimData(void):
-      rid_(read_input(".")),
+    SimData(const RawInputData& rid, LaneEmdenTables& tables):
+      rid_(rid),
       cfl_(0.2),
       rs_(rid_.gas_gamma),
       eos_(rid_.gas_gamma),
       Np_(512),
+      domain_(Np_),
       R_(1),
       M_(1),
       edges_(getedges(Np_,R_*1.01)),
@@ -283,35 +290,35 @@ namespace
 	0, 
 	eos_.dp2s(1e-25, 1e-26))),
       boundary_(bl_, br_),
-      interp_(boundary_),
-      Nemden_(1./rid_.star_gamma-1.0),
+      domain_boundary_(domain_, boundary_),
+      interp_(domain_boundary_),
+      Nemden_(1./(rid_.star_gamma-1.0)),
       cells_
       (calc_init
        (edges_,
 	M_,
 	R_,
 	Nemden_,
-	rid_.star_gamma)),
+	tables.get(rid_.star_gamma < 1.6))),
       Mbh_(1e6),
       Rt_(R_*pow(Mbh_/M_,1.0/3.0)),
       Rp_(Rt_/rid_.beta),
       source_
-      (M_,
-       R_,
-       Mbh_,
+      (Mbh_,
        Rp_,
        rid_.self_gravity,
-       rid_.star_gamma,
-       edges_),
+       domain_),
       sim_
       (cfl_,
-       cells_,
-       edges_,
+       domain_.LocalCells(cells_),
+       domain_.LocalEdges(edges_),
        interp_,
        eos_,
        rs_,
        source_)
-    {}
+    {
+      sim_.SetDomain(domain_);
+    }
 
     double getCFL(void) const
     {
@@ -353,18 +360,30 @@ namespace
       return sim_;
     }
 
+    const RawInputData& getInput(void) const
+    {
+      return rid_;
+    }
+
+    const DomainDecomposition& getDomain(void) const
+    {
+      return domain_;
+    }
+
   private:
     const RawInputData rid_;
     const double cfl_;
     const ExactRS rs_;
     const IdealGas eos_;
     const size_t Np_;
+    const DomainDecomposition domain_;
     const double R_;
     const double M_;
     const vector<double> edges_;
     const RigidWall bl_;
     const ConstantPrimitive br_;
     const SeveralBoundary boundary_;
+    const DomainBoundary domain_boundary_;
     const MinMod interp_;
     const double Nemden_;
     const vector<Primitive> cells_;
@@ -374,13 +393,163 @@ namespace
     const Gravity source_;
     hdsim sim_;
   };
-}
 
-int main(void)
-{
-	// Units G=1 M=solar R=solar t=1.592657944577715e+03
-	RawInputData raw_input_data = read_input(".");
-	SimData sim_data;
+  /*! \brief Reads the parameter sweep
+    \details Each line of ensemble.txt holds beta, star gamma, gas gamma and the output directory of one member.
+    Without the file the run has a single member described by the other input files.
+   */
+  vector<RawInputData> read_ensemble(const string& input_path, const RawInputData& base)
+  {
+    vector<RawInputData> res;
+    ifstream f((input_path+"/ensemble.txt").c_str());
+    if (!f)
+      {
+	res.push_back(base);
+	return res;
+      }
+    double beta = 0;
+    double star_gamma = 0;
+    double gas_gamma = 0;
+    string output_path;
+    while (f >> beta >> star_gamma >> gas_gamma >> output_path)
+      res.push_back(RawInputData(beta, star_gamma, gas_gamma, base.self_gravity, output_path));
+    f.close();
+    return res;
+  }
+
+  //! \brief Number of block time step levels, one without the file
+  size_t read_time_step_levels(const string& input_path)
+  {
+    double levels = 1;
+    ifstream f((input_path+"/time_step_levels.txt").c_str());
+    if (f)
+      f >> levels;
+    return static_cast<size_t>(levels);
+  }
+
+  /*! \brief Refinement criteria from refinement.txt
+    \details The file holds the max jump, min jump, max mass ratio, min width and density floor of
+    StandardRefinement. Without it the mesh is fixed.
+    \return The criteria or null
+   */
+  StandardRefinement* read_refinement(const string& input_path)
+  {
+    ifstream f((input_path+"/refinement.txt").c_str());
+    double max_jump = 0;
+    double min_jump = 0;
+    double max_mass_ratio = 0;
+    double min_width = 0;
+    double density_floor = 0;
+    if (!(f >> max_jump >> min_jump >> max_mass_ratio >> min_width >> density_floor))
+      return 0;
+    return new StandardRefinement(max_jump, min_jump, max_mass_ratio, min_width, density_floor);
+  }
+
+  /*! \brief Trimming of escaped cells from trimming.txt
+    \details The file holds the radius and the density floor beyond which the outermost cells are removed
+    \param input_path Directory of the file
+    \param max_radius Set to the radius
+    \param density_floor Set to the density floor
+    \return False without the file, then all the cells are kept
+   */
+  bool read_trimming(const string& input_path, double& max_radius, double& density_floor)
+  {
+    ifstream f((input_path+"/trimming.txt").c_str());
+    return static_cast<bool>(f >> max_radius >> density_floor);
+  }
+
+  /*! \brief Output to a single time series file per member from time_series.txt
+    \details The file holds the number of snapshots between flushes to disk. Without it every snapshot is
+    written to its own tide file.
+    \param input_path Directory of the file
+    \param flush_interval Set to the number of snapshots between flushes
+    \return False without the file
+   */
+  bool read_time_series(const string& input_path, size_t& flush_interval)
+  {
+    ifstream f((input_path+"/time_series.txt").c_str());
+    double buf = 0;
+    if (!(f >> buf))
+      return false;
+    flush_interval = static_cast<size_t>(buf);
+    return true;
+  }
+
+  /*! \brief Compression of the snapshot files from compression.txt
+    \details Each line holds the deflate level, 1 to shuffle or 0 not to and the chunk size, for the edges,
+    density, pressure and velocity in this order. A single line applies to all of them. Without the file the
+    datasets are deflated at level 6 without shuffling.
+    \param input_path Directory of the file
+    \return The compression
+   */
+  SnapshotCompression read_compression(const string& input_path)
+  {
+    ifstream f((input_path+"/compression.txt").c_str());
+    vector<CompressionSettings> settings;
+    double level = 0;
+    double shuffle = 0;
+    double chunk = 0;
+    while (settings.size() < 4 && f >> level >> shuffle >> chunk)
+      settings.push_back(CompressionSettings(static_cast<int>(level), shuffle > 0.5, static_cast<size_t>(chunk)));
+    if (settings.empty())
+      return SnapshotCompression();
+    SnapshotCompression res(settings[0]);
+    CompressionSettings* datasets[4] = { &res.edges, &res.density, &res.pressure, &res.velocity };
+    for (size_t i = 1; i < settings.size(); ++i)
+      *datasets[i] = settings[i];
+    return res;
+  }
+
+  /*! \brief Continues a member from its checkpoint when there is one
+    \details With a domain decomposition every process must find its own part, written at the same cycle
+    \param sim The simulation
+    \param domain The decomposition
+    \param fname The checkpoint of this process
+    \return The output schedule saved with the checkpoint, empty when the member starts afresh
+   */
+  vector<double> resume_member(hdsim& sim, const DomainDecomposition& domain, const string& fname)
+  {
+    const bool found = static_cast<bool>(ifstream(fname.c_str()));
+    const double processes = domain.Sum(found ? 1 : 0);
+    if (processes < 0.5)
+      return vector<double>();
+    if (processes < domain.GetSize() - 0.5)
+      throw UniversalError("Checkpoints of some processes are missing");
+    Checkpoint checkpoint;
+    string error;
+    try
+      {
+	read_checkpoint(fname, checkpoint);
+	if (domain.GetSize() > 1 && checkpoint.cells.size() != sim.GetCellArrays().size())
+	  error = "Checkpoint is from another domain decomposition";
+      }
+    catch (UniversalError const& eo)
+      {
+	error = eo.GetErrorMessage();
+      }
+    // All processes throw together, or none of them does
+    const double cycle = static_cast<double>(checkpoint.cycle);
+    if (domain.Sum(error.empty() && domain.Broadcast(cycle) == cycle ? 0 : 1) > 0.5)
+      throw UniversalError(error.empty() ? "Checkpoints of the processes are from different cycles" : error);
+    if (checkpoint.user.size() != 4)
+      throw UniversalError("Checkpoint was not written by this driver");
+    sim.Restart(checkpoint);
+    return checkpoint.user;
+  }
+
+  /*! \brief Runs one simulation until the star is disrupted
+    \param sim_data The simulation
+    \param tag Prefix of the progress messages
+    \param checkpoint_file Name of the checkpoint written every 500 cycles, removed when the member finishes
+    \param schedule Output schedule of a member resumed from a checkpoint, empty for a new one
+    \param writer Writes the snapshots in the background
+    \param series Receives the snapshots when set, otherwise each is written to its own tide file
+    \return Number of cell updates
+   */
+  double run_member(SimData& sim_data, const string& tag, const string& checkpoint_file,
+		    const vector<double>& schedule, SnapshotWriter& writer, TimeSeriesWriter* series)
+  {
+	const RawInputData& raw_input_data = sim_data.getInput();
 	double R = 1;
 	double M = 1;
 	double Mbh = 1e6;
@@ -390,7 +559,9 @@ int main(void)
 			     Mbh)*tan(fstart / 2)*
 	  (3 + pow(tan(fstart / 2), 2)) / 3;
 	hdsim& sim = sim_data.getSim();
-	sim.SetTime(tstart);
+	const DomainDecomposition& domain = sim_data.getDomain();
+	if (schedule.empty())
+		sim.SetTime(tstart);
 
 	double dt = 0.05;
 	double initd = sim_data.getCells().front().density;
@@ -398,28 +569,230 @@ int main(void)
 	double last = sim.GetTime();
 	double mind = maxd;
 	int counter = 0;
+	if (!schedule.empty())
+	{
+		counter = static_cast<int>(schedule[0]);
+		last = schedule[1];
+		maxd = schedule[2];
+		mind = schedule[3];
+	}
+	const size_t first_cycle = sim.GetCycle();
+	Checkpoint checkpoint;
+	// The central cell belongs to the first process
+	double central = domain.Broadcast(sim.GetCellArrays().density[0]);
 
-	while (sim.GetCells()[0].density> 
+	while (central> 
 	       max(0.25*initd,0.1*maxd) && 
 	       sim.GetTime()<0.6)
 	{
-		if (sim.GetCycle() % 500 == 0)
-			write_snapshot_to_hdf5(sim, "temp.h5");
-		if (sim.GetCycle() % 100 == 0)
-			cout << "Time = " << sim.GetTime() << " Cycle = " << sim.GetCycle() << endl;
+		if (sim.GetCycle() % 500 == 0 && sim.GetCycle() != first_cycle)
+		{
+			// The snapshots queued before the checkpoint must be on disk, a resumed run does not write them again
+			writer.Flush();
+			sim.GetCheckpoint(checkpoint);
+			const double saved[4] = { static_cast<double>(counter), last, maxd, mind };
+			checkpoint.user.assign(saved, saved + 4);
+			write_checkpoint(checkpoint, checkpoint_file);
+		}
+		if (sim.GetCycle() % 100 == 0 && domain.IsFirst())
+		{
+#pragma omp critical(console)
+			cout << tag << "Time = " << sim.GetTime() << " Cycle = " << sim.GetCycle() << endl;
+		}
 		sim.TimeAdvance2();
-		if (sim.GetTime() - last > dt || sim.GetCycle() == 0 || sim.GetCells()[0].density>1.02*maxd || 
-			sim.GetCells()[0].density*1.02<mind)
+		central = domain.Broadcast(sim.GetCellArrays().density[0]);
+		if (sim.GetTime() - last > dt || sim.GetCycle() == 0 || central>1.02*maxd || 
+			central*1.02<mind)
 		{
-		  write_snapshot_to_hdf5
-		    (sim,
-		     raw_input_data.output_path+"/tide_" + 
-		     int2str(counter) + ".h5");
+		  if (series)
+		    writer.Write(sim, domain, *series);
+		  else
+		    writer.Write
+		      (sim,
+		       domain,
+		       raw_input_data.output_path+"/tide_" + 
+		       int2str(counter) + ".h5");
 		  last = sim.GetTime();
 		  ++counter;
-		  maxd = max(maxd, sim.GetCells()[0].density);
-		  mind = sim.GetCells()[0].density;
+		  maxd = max(maxd, central);
+		  mind = central;
 		}
 	}
+	remove(checkpoint_file.c_str());
+	return domain.Sum(static_cast<double>(sim.GetCellUpdates()));
+  }
+
+  string member_tag(size_t i, size_t Nmembers)
+  {
+    return Nmembers == 1 ? string() : "Member " + int2str(static_cast<int>(i)) + ": ";
+  }
+
+  //! \brief Each process of a decomposed run keeps its own checkpoint
+  string member_checkpoint_file(const RawInputData& member, size_t Nmembers, const DomainDecomposition& domain)
+  {
+    const string base = Nmembers == 1 ? string("checkpoint") : member.output_path + "/checkpoint";
+    return domain.GetSize() > 1 ? base + "_" + int2str(domain.GetRank()) + ".bin" : base + ".bin";
+  }
+
+  //! \brief Runs the members one after the other, each on all the threads
+  void run_sequential(boost::ptr_vector<SimData>& sims, const vector<RawInputData>& members,
+		      const vector<vector<double> >& schedules, vector<double>& updates, SnapshotWriter& writer,
+		      boost::ptr_vector<TimeSeriesWriter>& series)
+  {
+    for (size_t i = 0; i < members.size(); ++i)
+      {
+#ifdef _OPENMP
+	// Set OMP_NUM_THREADS to change, the results do not depend on it
+	sims[i].getSim().SetThreads(static_cast<size_t>(omp_get_max_threads()));
+#endif
+	updates[i] = run_member(sims[i], member_tag(i, members.size()),
+				member_checkpoint_file(members[i], members.size(), sims[i].getDomain()), schedules[i], writer,
+				series.empty() ? 0 : &series[i]);
+      }
+  }
+}
+
+int main(void)
+{
+#ifdef HDSIM_MPI
+	MPI_Init(0, 0);
+#endif
+	// Units G=1 M=solar R=solar t=1.592657944577715e+03
+	RawInputData raw_input_data = read_input(".");
+	const vector<RawInputData> members = read_ensemble(".", raw_input_data);
+	const size_t Nmembers = members.size();
+	LaneEmdenTables tables;
+	boost::ptr_vector<SimData> sims;
+	const size_t levels = read_time_step_levels(".");
+	const boost::scoped_ptr<StandardRefinement> refinement(read_refinement("."));
+	double trim_radius = 0;
+	double trim_density = 0;
+	const bool trimming = read_trimming(".", trim_radius, trim_density);
+	for (size_t i = 0; i < Nmembers; ++i)
+	{
+		sims.push_back(new SimData(members[i], tables));
+		if (sims.back().getDomain().IsFirst())
+			cout << member_tag(i, Nmembers) << "Gas adiabatic index " << DescribeIndex(members[i].gas_gamma) << endl;
+		sims.back().getSim().SetTimeStepLevels(levels);
+		sims.back().getSim().SetRefinement(refinement.get());
+		if (trimming)
+			sims.back().getSim().SetTrimming(trim_radius, trim_density);
+	}
+
+	// Members with a checkpoint continue from it, the others start afresh
+	vector<vector<double> > schedules(Nmembers);
+	try
+	{
+		for (size_t i = 0; i < Nmembers; ++i)
+		{
+			schedules[i] = resume_member(sims[i].getSim(), sims[i].getDomain(),
+				member_checkpoint_file(members[i], Nmembers, sims[i].getDomain()));
+			if (!schedules[i].empty() && sims[i].getDomain().IsFirst())
+				cout << member_tag(i, Nmembers) << "Resumed at cycle " << sims[i].getSim().GetCycle() << endl;
+		}
+	}
+	catch (UniversalError const& eo)
+	{
+		cout << "Could not resume: " << eo.GetErrorMessage() << endl;
+#ifdef HDSIM_MPI
+		MPI_Abort(MPI_COMM_WORLD, 1);
+#endif
+		return 1;
+	}
+
+	// One time series per member, destroyed after the writer that appends to them. HDF5 can not reliably reopen
+	// a file that was not closed, so a resumed member starts a new series named after the cycle it resumed at.
+	boost::ptr_vector<TimeSeriesWriter> series;
+	size_t flush_interval = 0;
+	if (read_time_series(".", flush_interval))
+		for (size_t i = 0; i < Nmembers; ++i)
+			series.push_back(new TimeSeriesWriter(members[i].output_path + (schedules[i].empty() ? string("/tide.h5") :
+				"/tide." + int2str(static_cast<int>(sims[i].getSim().GetCycle())) + ".h5"), flush_interval));
+
+	vector<double> updates(Nmembers, 0);
+	// Shared by all members, its thread is the only one that calls HDF5
+	SnapshotWriter writer(2, read_compression("."));
+	const double start = wall_time();
+#ifdef HDSIM_MPI
+	// Every process takes part in every member, so the members run one after the other. A failed process
+	// would leave the others waiting for it forever
+	try
+	{
+		run_sequential(sims, members, schedules, updates, writer, series);
+		writer.Flush();
+	}
+	catch (UniversalError const& eo)
+	{
+		cout << "Process " << sims[0].getDomain().GetRank() << " failed: " << eo.GetErrorMessage() << endl;
+		MPI_Abort(MPI_COMM_WORLD, 1);
+	}
+	catch (H5::Exception const& eo)
+	{
+		cout << "Process " << sims[0].getDomain().GetRank() << " failed: " << eo.getDetailMsg() << endl;
+		MPI_Abort(MPI_COMM_WORLD, 1);
+	}
+#else
+	if (Nmembers == 1)
+		run_sequential(sims, members, schedules, updates, writer, series);
+	else
+	{
+		// Members are tasks in a shared pool, an idle thread takes the next member whenever one finishes
+#pragma omp parallel
+#pragma omp single
+		for (size_t i = 0; i < Nmembers; ++i)
+		{
+#pragma omp task firstprivate(i) shared(sims, members, schedules, updates)
+			{
+				try
+				{
+					updates[i] = run_member(sims[i], member_tag(i, Nmembers),
+						member_checkpoint_file(members[i], Nmembers, sims[i].getDomain()), schedules[i], writer,
+						series.empty() ? 0 : &series[i]);
+				}
+				// A failed member does not stop the others
+				catch (UniversalError const& eo)
+				{
+#pragma omp critical(console)
+					cout << "Member " << i << " failed: " << eo.GetErrorMessage() << endl;
+				}
+				catch (H5::Exception const& eo)
+				{
+#pragma omp critical(console)
+					cout << "Member " << i << " failed: " << eo.getDetailMsg() << endl;
+				}
+			}
+		}
+	}
+	writer.Flush();
+#endif
+	const double elapsed = wall_time() - start;
+
+	double total = 0;
+	double avoided = 0;
+	for (size_t i = 0; i < Nmembers; ++i)
+	{
+		total += updates[i];
+		avoided += static_cast<double>(sims[i].getSim().GetCellUpdatesAvoided());
+	}
+	if (sims[0].getDomain().IsFirst())
+	{
+		cout << "Members = " << Nmembers << " Cell updates = " << total << " Seconds = " << elapsed <<
+			" Cell updates per second = " << total / elapsed << endl;
+		// Block time steps do the work of this many global steps with fewer cell updates
+		if (levels > 1)
+			cout << "Cell updates avoided = " << avoided << " Speedup in cell updates = " <<
+				(total + avoided) / total << endl;
+		if (trimming)
+			for (size_t i = 0; i < Nmembers; ++i)
+			{
+				Extensive const& outflow = sims[i].getSim().GetOutflow();
+				cout << member_tag(i, Nmembers) << "Trimmed cells = " << sims[i].getSim().GetTrimmedCells() <<
+					" Outflow mass = " << outflow.mass << " momentum = " << outflow.momentum << " energy = " <<
+					outflow.energy << endl;
+			}
+	}
+#ifdef HDSIM_MPI
+	MPI_Finalize();
+#endif
 	return 0;
 }
@@ -0,0 +1,101 @@
+// Counts the heap allocations of steady state cycles of Sod's shock tube with each way of stepping: the default,
+// the fused engine, the Riemann cache and two levels of block time steps. Fails if any cycle allocates, everything
+// a cycle needs is kept from one cycle to the next.
+// Usage: allocations [cells] [cycles]
+#include "hdsim.hpp"
+#include "tool_util.hpp"
+#include <iostream>
+#include <cstdlib>
+#include <new>
+
+namespace
+{
+	size_t allocations = 0;
+
+	void* allocate(size_t n)
+	{
+#pragma omp atomic
+		++allocations;
+		void *res = malloc(n > 0 ? n : 1);
+		if (!res)
+			throw bad_alloc();
+		return res;
+	}
+}
+
+void* operator new(size_t n)
+{
+	return allocate(n);
+}
+
+void* operator new[](size_t n)
+{
+	return allocate(n);
+}
+
+void operator delete(void *p) noexcept
+{
+	free(p);
+}
+
+void operator delete[](void *p) noexcept
+{
+	free(p);
+}
+
+void operator delete(void *p, size_t) noexcept
+{
+	free(p);
+}
+
+void operator delete[](void *p, size_t) noexcept
+{
+	free(p);
+}
+
+int main(int argc, char **argv)
+{
+	const size_t N = argc > 1 ? static_cast<size_t>(atol(argv[1])) : 1000;
+	const size_t cycles = argc > 2 ? static_cast<size_t>(atol(argv[2])) : 100;
+
+	const double gamma = 5.0 / 3.0;
+	IdealGas eos(gamma);
+	ExactRS rs(gamma);
+	RigidWall wall;
+	const ConstantPrimitive outer(Primitive(0.125, 0.1, 0, eos.dp2s(0.125, 0.1)));
+	const SeveralBoundary boundary(wall, outer);
+	MinMod interp(boundary);
+	ZeroForce force;
+	const vector<double> edges = uniform_edges(N);
+	const vector<Primitive> cells = sod_cells(edges, eos);
+
+	// Setting up allocates, so a count of zero here means the replacement operator new is not in use
+	if (allocations == 0)
+	{
+		cout << "operator new is not counted" << endl;
+		return 1;
+	}
+
+	char const* modes[4] = { "default", "fused", "cache", "2 levels" };
+	bool good = true;
+	for (size_t mode = 0; mode < 4; ++mode)
+	{
+		hdsim sim(0.3, cells, edges, interp, eos, rs, force);
+		sim.SetFusedStepping(mode == 1);
+		if (mode == 2)
+			sim.SetRiemannCache(1e-6);
+		if (mode == 3)
+			sim.SetTimeStepLevels(2);
+		// The first cycles size the buffers
+		for (size_t c = 0; c < 10; ++c)
+			sim.TimeAdvance2();
+		const size_t before = allocations;
+		for (size_t c = 0; c < cycles; ++c)
+			sim.TimeAdvance2();
+		const size_t count = allocations - before;
+		good = good && count == 0;
+		cout << modes[mode] << ": " << count << " allocations in " << cycles << " cycles" << endl;
+	}
+	cout << (good ? "no allocations" : "ALLOCATES") << endl;
+	return good ? 0 : 1;
+}
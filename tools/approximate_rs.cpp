@@ -0,0 +1,140 @@
+// Checks the Riemann solvers on the five tests of Toro's chapter 4 and on a weak jump. The exact solver must give
+// Toro's star pressure and velocity, HLLC, the two shock and the linearized solvers are compared with it, and
+// HybridRS must send every weak interface to its approximate solver and every strong one to the exact solver,
+// one at a time and over ranges, and count each.
+// Usage: approximate_rs
+#include "ApproximateRS.hpp"
+#include <iostream>
+#include <iomanip>
+#include <cmath>
+#include <algorithm>
+
+namespace
+{
+	//! \brief A Riemann problem with its star state
+	class RiemannTest
+	{
+	public:
+		char const* name;
+		double left[3];
+		double right[3];
+		double pressure;
+		double velocity;
+		//! \brief Relative precision of the tabulated star state
+		double figures;
+		//! \brief Largest relative error of the star pressure allowed to HLLC, the two shock and linearized solvers
+		double tolerance[3];
+	};
+
+	Primitive make_primitive(double const* values)
+	{
+		return Primitive(values[0], values[2], values[1], 0);
+	}
+
+	// Error of the velocity relative to the larger sound speed
+	double velocity_error(double a, double b, Primitive const& left, Primitive const& right, double gamma)
+	{
+		return fabs(a - b) / max(sqrt(gamma*left.pressure / left.density), sqrt(gamma*right.pressure / right.density));
+	}
+
+	bool same(RSsolution const& a, RSsolution const& b)
+	{
+		return a.pressure == b.pressure && a.velocity == b.velocity;
+	}
+}
+
+int main(void)
+{
+	const double gamma = 1.4;
+	const ExactRS exact(gamma);
+	const HLLC hllc(gamma);
+	const TwoShockRS two_shock(gamma);
+	const LinearizedRS linearized(gamma);
+	RiemannSolver const* approximate[3] = { &hllc, &two_shock, &linearized };
+	char const* names[3] = { "hllc", "two shock", "linearized" };
+
+	/* Density, velocity and pressure of each side, the star state from Toro's table 4.3 and its precision, then the
+	error allowed to each approximation, a little above what it gives. Only the two shock solver is meant for
+	strong shocks, the others are for weak jumps, and in the 123 problem all three find a vacuum. */
+	const RiemannTest tests[6] = {
+		{ "sod", { 1, 0, 1 }, { 0.125, 0, 0.1 }, 0.30313, 0.92745, 1e-4, { 0.4, 0.05, 0.9 } },
+		{ "123", { 1, -2, 0.4 }, { 1, 2, 0.4 }, 0.00189, 0, 3e-3, { 1, 1, 1 } },
+		{ "left blast", { 1, 0, 1000 }, { 1, 0, 0.01 }, 460.894, 19.5975, 1e-4, { 0.1, 0.01, 0.1 } },
+		{ "right blast", { 1, 0, 0.01 }, { 1, 0, 100 }, 46.0950, -6.19633, 1e-4, { 0.1, 0.01, 0.1 } },
+		{ "collision", { 5.99924, 19.5975, 460.894 }, { 5.99242, -6.19633, 46.0950 }, 1691.64, 8.68975, 1e-4,
+			{ 0.7, 0.3, 0.6 } },
+		{ "weak", { 1, 0, 1 }, { 0.99, 0.001, 0.99 }, 0, 0, 0, { 1e-4, 1e-4, 1e-4 } } };
+
+	bool good = true;
+	cout << "test         exact error    solver      pressure error  velocity error" << endl;
+	for (size_t t = 0; t < 6; ++t)
+	{
+		RiemannTest const& test = tests[t];
+		const Primitive left = make_primitive(test.left);
+		const Primitive right = make_primitive(test.right);
+		const RSsolution reference = exact.Solve(left, right);
+		// The weak jump has no tabulated solution
+		double exact_error = 0;
+		if (test.pressure > 0)
+		{
+			exact_error = max(fabs(reference.pressure - test.pressure) / test.pressure,
+				velocity_error(reference.velocity, test.velocity, left, right, gamma));
+			good = good && exact_error < test.figures;
+		}
+		for (size_t k = 0; k < 3; ++k)
+		{
+			const RSsolution res = approximate[k]->Solve(left, right);
+			const double pressure_error = fabs(res.pressure - reference.pressure) / reference.pressure;
+			const double v_error = velocity_error(res.velocity, reference.velocity, left, right, gamma);
+			const bool valid = res.pressure >= 0 && pressure_error <= test.tolerance[k];
+			good = good && valid;
+			cout << std::left << setw(13) << (k == 0 ? test.name : "");
+			if (k == 0)
+				cout << setw(15) << setprecision(3) << exact_error;
+			else
+				cout << setw(15) << "";
+			cout << setw(12) << names[k] << std::right << setw(14) << setprecision(4) << pressure_error <<
+				setw(16) << v_error << (valid ? "" : "  TOO FAR") << endl;
+		}
+	}
+
+	// The weak jump goes to the approximation, the others to the exact solver
+	const double threshold = 0.1;
+	vector<pair<Primitive, Primitive> > states;
+	vector<char> weak;
+	for (size_t repeat = 0; repeat < 3; ++repeat)
+		for (size_t t = 0; t < 6; ++t)
+		{
+			states.push_back(pair<Primitive, Primitive>(make_primitive(tests[t].left),
+				make_primitive(tests[t].right)));
+			weak.push_back(t == 5);
+		}
+	const size_t expected_weak = static_cast<size_t>(count(weak.begin(), weak.end(), 1));
+	const size_t expected_strong = states.size() - expected_weak;
+	HybridRS counted(linearized, exact, gamma, threshold);
+	bool routed = true;
+	for (size_t i = 0; i < states.size(); ++i)
+	{
+		RiemannSolver const& expected = weak[i] ? static_cast<RiemannSolver const&>(linearized) : exact;
+		routed = routed && same(counted.Solve(states[i].first, states[i].second),
+			expected.Solve(states[i].first, states[i].second));
+	}
+	const bool single_counts = counted.GetApproximateCount() == expected_weak &&
+		counted.GetExactCount() == expected_strong;
+	counted.ResetCounters();
+	vector<RSsolution> res(states.size());
+	counted.Solve(states, res, 0, states.size());
+	for (size_t i = 0; i < states.size(); ++i)
+	{
+		RiemannSolver const& expected = weak[i] ? static_cast<RiemannSolver const&>(linearized) : exact;
+		routed = routed && same(res[i], expected.Solve(states[i].first, states[i].second));
+	}
+	const bool range_counts = counted.GetApproximateCount() == expected_weak &&
+		counted.GetExactCount() == expected_strong;
+	good = good && routed && single_counts && range_counts;
+	cout << "hybrid: " << expected_weak << " weak and " << expected_strong << " strong interfaces, routed " <<
+		(routed ? "right" : "WRONG") << ", counted one at a time " << (single_counts ? "right" : "WRONG") <<
+		", counted over a range " << (range_counts ? "right" : "WRONG") << endl;
+	cout << (good ? "all within bounds" : "FAILED") << endl;
+	return good ? 0 : 1;
+}
@@ -0,0 +1,79 @@
+// Compares block time steps with the global step on a shock tube whose cells grow geometrically from the left
+// end, so that the cells' own time steps span several levels. Prints the cell updates, the time, the total energy
+// and the difference from the global step run.
+// Usage: block_steps [cells] [levels] [end time] [growth]
+#include "hdsim.hpp"
+#include "tool_util.hpp"
+#include <iostream>
+#include <iomanip>
+#include <cstdlib>
+#include <cmath>
+#include <ctime>
+
+namespace
+{
+	double total_energy(hdsim const& sim)
+	{
+		ExtensiveArrays const& extensives = sim.GetExtensives();
+		double res = 0;
+		for (size_t i = 0; i < extensives.size(); ++i)
+			res += extensives.energy[i];
+		return res;
+	}
+
+	double l1_difference(PrimitiveArrays const& a, PrimitiveArrays const& b, vector<double> const& edges)
+	{
+		double res = 0;
+		for (size_t i = 0; i < a.size(); ++i)
+			res += fabs(a.density[i] - b.density[i])*(edges[i + 1] - edges[i]);
+		return res;
+	}
+}
+
+int main(int argc, char **argv)
+{
+	const size_t N = argc > 1 ? static_cast<size_t>(atol(argv[1])) : 1000;
+	const size_t levels = argc > 2 ? static_cast<size_t>(atol(argv[2])) : 6;
+	const double tend = argc > 3 ? atof(argv[3]) : 0.1;
+	const double growth = argc > 4 ? atof(argv[4]) : 1.004;
+
+	const double gamma = 5.0 / 3.0;
+	IdealGas eos(gamma);
+	ExactRS rs(gamma);
+	RigidWall boundary;
+	MinMod interp(boundary);
+	ZeroForce force;
+	vector<double> edges(N + 1, 0);
+	double dx = 1;
+	for (size_t i = 0; i < N; ++i)
+	{
+		edges[i + 1] = edges[i] + dx;
+		dx *= growth;
+	}
+	for (size_t i = 0; i <= N; ++i)
+		edges[i] /= edges[N];
+	const vector<Primitive> cells = sod_cells(edges, eos);
+
+	cout << "cells " << N << " levels " << levels << " end time " << tend << " smallest/largest cell " <<
+		(edges[1] - edges[0]) / (edges[N] - edges[N - 1]) << endl;
+	cout << "levels  cycles  cell updates  avoided  seconds  energy error  L1 difference" << endl;
+	PrimitiveArrays reference;
+	const size_t runs[2] = { 1, levels };
+	for (size_t r = 0; r < 2; ++r)
+	{
+		hdsim sim(0.3, cells, edges, interp, eos, rs, force);
+		sim.SetTimeStepLevels(runs[r]);
+		const double energy = total_energy(sim);
+		const clock_t start = clock();
+		while (sim.GetTime() < tend)
+			sim.TimeAdvance2();
+		const double elapsed = static_cast<double>(clock() - start) / CLOCKS_PER_SEC;
+		if (r == 0)
+			reference = sim.GetCellArrays();
+		cout << setw(6) << runs[r] << setw(8) << sim.GetCycle() << setw(14) << sim.GetCellUpdates() << setw(9) <<
+			sim.GetCellUpdatesAvoided() << setw(9) << setprecision(3) << elapsed << setw(14) <<
+			(total_energy(sim) - energy) / energy << setw(15) <<
+			l1_difference(sim.GetCellArrays(), reference, sim.GetEdges()) << endl;
+	}
+	return 0;
+}
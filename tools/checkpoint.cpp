@@ -0,0 +1,90 @@
+// Stops a Sod shock tube halfway, writes a checkpoint, restarts a new simulation from it and checks that both
+// reach bitwise identical states, with the default engine, the fused engine and block time steps. Also times writing and reading the checkpoint against writing a snapshot.
+// Usage: checkpoint [cells] [cycles] [output directory]
+#include "hdsim.hpp"
+#include "hdf_util.hpp"
+#include "tool_util.hpp"
+#include <iostream>
+#include <cstdlib>
+#include <cstdio>
+
+namespace
+{
+	void configure(hdsim &sim, size_t mode)
+	{
+		if (mode == 1)
+			sim.SetFusedStepping(true);
+		if (mode == 2)
+			sim.SetTimeStepLevels(3);
+	}
+
+	bool same_simulation(hdsim const& first, hdsim const& second)
+	{
+		ExtensiveArrays const& ea = first.GetExtensives();
+		ExtensiveArrays const& eb = second.GetExtensives();
+		return first.GetTime() == second.GetTime() && first.GetCycle() == second.GetCycle() &&
+			first.GetCellUpdates() == second.GetCellUpdates() &&
+			same_state(first.GetCellArrays(), first.GetEdges(), second.GetCellArrays(), second.GetEdges()) &&
+			ea.mass == eb.mass && ea.momentum == eb.momentum && ea.energy == eb.energy;
+	}
+}
+
+int main(int argc, char **argv)
+{
+	const size_t N = argc > 1 ? static_cast<size_t>(atol(argv[1])) : 1000000;
+	const size_t cycles = argc > 2 ? static_cast<size_t>(atol(argv[2])) : 20;
+	const string dir = argc > 3 ? argv[3] : ".";
+
+	const double gamma = 5.0 / 3.0;
+	IdealGas eos(gamma);
+	ExactRS rs(gamma);
+	RigidWall boundary;
+	MinMod interp(boundary);
+	ZeroForce force;
+	const vector<double> edges = uniform_edges(N);
+	const vector<Primitive> cells = sod_cells(edges, eos);
+
+	const string fname = dir + "/checkpoint.bin";
+	const string snapshot_name = dir + "/checkpoint_snapshot.h5";
+	char const* modes[3] = { "default", "fused", "block steps" };
+	bool all_same = true;
+	cout << "cells " << N << " cycles " << cycles << endl;
+	for (size_t mode = 0; mode < 3; ++mode)
+	{
+		hdsim sim(0.3, cells, edges, interp, eos, rs, force);
+		configure(sim, mode);
+		for (size_t c = 0; c < cycles / 2; ++c)
+			sim.TimeAdvance2();
+		Checkpoint checkpoint;
+		double start = wall_time();
+		sim.GetCheckpoint(checkpoint);
+		write_checkpoint(checkpoint, fname);
+		const double write_time = wall_time() - start;
+
+		hdsim restarted(0.3, cells, edges, interp, eos, rs, force);
+		configure(restarted, mode);
+		start = wall_time();
+		Checkpoint loaded;
+		read_checkpoint(fname, loaded);
+		restarted.Restart(loaded);
+		const double read_time = wall_time() - start;
+
+		start = wall_time();
+		write_snapshot_to_hdf5(sim, snapshot_name);
+		const double snapshot_time = wall_time() - start;
+		remove(snapshot_name.c_str());
+
+		for (size_t c = cycles / 2; c < cycles; ++c)
+		{
+			sim.TimeAdvance2();
+			restarted.TimeAdvance2();
+		}
+		const bool same = same_simulation(sim, restarted);
+		all_same = all_same && same;
+		cout << modes[mode] << ": seconds writing the checkpoint " << write_time << " reading and restarting " <<
+			read_time << " writing a snapshot " << snapshot_time << ", identical after restart " <<
+			(same ? "yes" : "NO") << endl;
+	}
+	remove(fname.c_str());
+	return all_same ? 0 : 1;
+}
@@ -0,0 +1,62 @@
+// Checks the domain decomposition, runs a Sod shock tube split over all MPI processes and compares the gathered
+// result with a run of the whole mesh on the first process, which must agree bit for bit.
+// Usage: mpirun -np <processes> domain_check [cells] [cycles] [fused] [threads]
+#include "hdsim.hpp"
+#include "DomainDecomposition.hpp"
+#include "tool_util.hpp"
+#include <iostream>
+#include <cstdlib>
+
+#ifdef HDSIM_MPI
+int main(int argc, char **argv)
+{
+	MPI_Init(&argc, &argv);
+	const size_t N = argc > 1 ? static_cast<size_t>(atol(argv[1])) : 1000;
+	const size_t cycles = argc > 2 ? static_cast<size_t>(atol(argv[2])) : 300;
+	const bool fused = argc > 3 && atoi(argv[3]) != 0;
+	const size_t threads = argc > 4 ? static_cast<size_t>(atol(argv[4])) : 1;
+
+	const double gamma = 5.0 / 3.0;
+	IdealGas eos(gamma);
+	ExactRS rs(gamma);
+	RigidWall boundary;
+	ZeroForce force;
+	const vector<double> edges = uniform_edges(N);
+	const vector<Primitive> cells = sod_cells(edges, eos);
+
+	DomainDecomposition domain(N);
+	DomainBoundary domain_boundary(domain, boundary);
+	MinMod domain_interp(domain_boundary);
+	hdsim sim(0.3, domain.LocalCells(cells), domain.LocalEdges(edges), domain_interp, eos, rs, force);
+	sim.SetDomain(domain);
+	sim.SetFusedStepping(fused);
+	sim.SetThreads(threads);
+	for (size_t c = 0; c < cycles; ++c)
+		sim.TimeAdvance2();
+	PrimitiveArrays global_cells;
+	vector<double> global_edges;
+	domain.Gather(sim.GetCellArrays(), sim.GetEdges(), global_cells, global_edges);
+
+	int res = 0;
+	if (domain.IsFirst())
+	{
+		MinMod interp(boundary);
+		hdsim serial(0.3, cells, edges, interp, eos, rs, force);
+		for (size_t c = 0; c < cycles; ++c)
+			serial.TimeAdvance2();
+		const bool same = same_state(serial.GetCellArrays(), serial.GetEdges(), global_cells, global_edges) &&
+			serial.GetTime() == sim.GetTime();
+		cout << "processes " << domain.GetSize() << " cells " << N << " cycles " << cycles << (fused ? " fused" : "")
+			<< " threads " << threads << " identical " << (same ? "yes" : "NO") << endl;
+		res = same ? 0 : 1;
+	}
+	MPI_Finalize();
+	return res;
+}
+#else
+int main(void)
+{
+	cout << "domain_check needs a build with mpi=1" << endl;
+	return 0;
+}
+#endif
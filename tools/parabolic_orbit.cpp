@@ -0,0 +1,89 @@
+// Checks the closed form parabolic orbit against Barker's equation and against the bisection it replaced, and times
+// both. Prints the largest residual of Barker's equation, the largest anomaly difference from the bisection, the
+// largest relative difference of the distance from 2Rp/(1+cos f) and the evaluations per second of each. Fails if
+// the residual or the distance difference is above 1e-12, or the anomaly differs from the bisection, which stops at
+// a bracket of 1e-6, by more than 1e-6.
+// Usage: parabolic_orbit [times] [pericenter] [mass]
+#define _USE_MATH_DEFINES
+#include "ParabolicOrbit.hpp"
+#include <boost/math/tools/roots.hpp>
+#include <iostream>
+#include <iomanip>
+#include <cstdlib>
+#include <cmath>
+#include <ctime>
+#include <vector>
+
+using namespace std;
+
+namespace
+{
+	class BarkerResidual
+	{
+	private:
+		double t_, time_scale_;
+	public:
+		BarkerResidual(double t, double time_scale) :t_(t), time_scale_(time_scale) {}
+		double operator()(double f)const
+		{
+			const double D = tan(f / 2);
+			return t_ - time_scale_*D*(3 + D*D) / 3;
+		}
+	};
+
+	struct TerminationCondition
+	{
+		bool operator() (double min, double max)const
+		{
+			return fabs(min - max) <= 0.000001;
+		}
+	};
+
+	double bisect_anomaly(double t, double time_scale)
+	{
+		return boost::math::tools::bisect(BarkerResidual(t, time_scale), -M_PI, M_PI, TerminationCondition()).first;
+	}
+}
+
+int main(int argc, char **argv)
+{
+	const size_t N = argc > 1 ? static_cast<size_t>(atol(argv[1])) : 100000;
+	const double Rp = argc > 2 ? atof(argv[2]) : 1;
+	const double M = argc > 3 ? atof(argv[3]) : 1;
+	const double time_scale = sqrt(2 * Rp*Rp*Rp / M);
+
+	// Times from well before to well after pericenter
+	vector<double> times(N);
+	for (size_t i = 0; i < N; ++i)
+		times[i] = time_scale*(20 * static_cast<double>(i) / static_cast<double>(N) - 10);
+
+	vector<double> closed(N), bisected(N);
+	const ParabolicOrbit orbit(Rp, M);
+	clock_t start = clock();
+	for (size_t i = 0; i < N; ++i)
+		closed[i] = orbit.GetTrueAnomaly(times[i]);
+	const double closed_time = static_cast<double>(clock() - start) / CLOCKS_PER_SEC;
+	start = clock();
+	for (size_t i = 0; i < N; ++i)
+		bisected[i] = bisect_anomaly(times[i], time_scale);
+	const double bisect_time = static_cast<double>(clock() - start) / CLOCKS_PER_SEC;
+
+	double residual = 0;
+	double difference = 0;
+	double distance = 0;
+	for (size_t i = 0; i < N; ++i)
+	{
+		residual = max(residual, fabs(BarkerResidual(times[i], time_scale)(closed[i])) / time_scale);
+		difference = max(difference, fabs(closed[i] - bisected[i]));
+		const double R = 2 * Rp / (1 + cos(closed[i]));
+		distance = max(distance, fabs(orbit.GetDistance(times[i]) - R) / R);
+	}
+	cout << setprecision(4) << "max Barker residual / time scale  " << residual << endl;
+	cout << "max anomaly difference to bisection  " << difference << endl;
+	cout << "max relative distance difference to 2Rp/(1+cos f)  " << distance << endl;
+	cout << "closed form evaluations/s  " << static_cast<double>(N) / closed_time << endl;
+	cout << "bisection evaluations/s    " << static_cast<double>(N) / bisect_time << endl;
+	const bool good = residual < 1e-12 && distance < 1e-12 && difference <= 1e-6;
+	cout << (good ? "agree" : "FAILED") << endl;
+	return good ? 0 : 1;
+}
@@ -0,0 +1,105 @@
+// Times writing a snapshot with chunks deflated by HDF5 on one thread against chunks deflated on all threads and
+// written directly, for a few compression settings. Every file is read back through the HDF5 filters and must
+// give the original data.
+// Usage: parallel_compression [cells] [output directory]
+#include "hdf_util.hpp"
+#include "tool_util.hpp"
+#include <iostream>
+#include <iomanip>
+#include <cstdlib>
+#include <cstdio>
+#include <cmath>
+
+namespace
+{
+	long file_size(string const& fname)
+	{
+		FILE *f = fopen(fname.c_str(), "rb");
+		if (!f)
+			return 0;
+		fseek(f, 0, SEEK_END);
+		const long res = ftell(f);
+		fclose(f);
+		return res;
+	}
+
+	// A snapshot written the way it was before, with HDF5 deflating each dataset at level 6
+	void write_serial(PrimitiveArrays const& cells, vector<double> const& edges, string const& fname)
+	{
+		H5::H5File file(H5std_string(fname), H5F_ACC_TRUNC);
+		H5::Group geometry = file.createGroup("/geometry");
+		H5::Group hydrodynamic = file.createGroup("/hydrodynamic");
+		H5::FloatType datatype(PredType::NATIVE_DOUBLE);
+		datatype.setOrder(H5T_ORDER_LE);
+		write_std_vector_to_hdf5(file, vector<double>(1, 0.0), "time");
+		write_std_vector_to_hdf5(file, vector<int>(1, 0), "cycle");
+		write_std_vector_to_hdf5(geometry, edges, "edges", datatype);
+		write_std_vector_to_hdf5(hydrodynamic, cells.density, "density", datatype);
+		write_std_vector_to_hdf5(hydrodynamic, cells.pressure, "pressure", datatype);
+		write_std_vector_to_hdf5(hydrodynamic, cells.velocity, "velocity", datatype);
+	}
+
+	bool same_data(Snapshot const& snapshot, PrimitiveArrays const& cells, vector<double> const& edges)
+	{
+		bool res = snapshot.edges == edges && snapshot.cells.size() == cells.size();
+		for (size_t i = 0; res && i < cells.size(); ++i)
+			res = snapshot.cells[i].density == cells.density[i] && snapshot.cells[i].pressure == cells.pressure[i] &&
+				snapshot.cells[i].velocity == cells.velocity[i];
+		return res;
+	}
+}
+
+int main(int argc, char **argv)
+{
+	const size_t N = argc > 1 ? static_cast<size_t>(atol(argv[1])) : 2000000;
+	const string dir = argc > 2 ? argv[2] : ".";
+
+	// A smooth profile with a shock, like a star after pericenter
+	vector<double> edges(N + 1);
+	for (size_t i = 0; i <= N; ++i)
+		edges[i] = pow(static_cast<double>(i) / static_cast<double>(N), 1.5);
+	PrimitiveArrays cells;
+	cells.resize(N);
+	for (size_t i = 0; i < N; ++i)
+	{
+		const double x = 0.5*(edges[i] + edges[i + 1]);
+		cells.density[i] = (x < 0.7 ? 1 : 0.125)*exp(-3 * x);
+		cells.pressure[i] = pow(cells.density[i], 5.0 / 3.0);
+		cells.velocity[i] = x < 0.7 ? -0.1*x : 0.3*(1 - x);
+	}
+
+	int threads = 1;
+#ifdef _OPENMP
+	threads = omp_get_max_threads();
+#endif
+	cout << "cells " << N << " threads " << threads << endl;
+	cout << "writer             level shuffle  chunk   seconds        bytes  identical" << endl;
+	bool all_same = true;
+	const string serial_name = dir + "/compression_serial.h5";
+	double start = wall_time();
+	write_serial(cells, edges, serial_name);
+	double elapsed = wall_time() - start;
+	bool same = same_data(read_hdf5_snapshot(serial_name), cells, edges);
+	all_same = all_same && same;
+	cout << "hdf5 filters           6      no 100000" << setw(10) << setprecision(3) << elapsed << setw(13) <<
+		file_size(serial_name) << setw(11) << (same ? "yes" : "NO") << endl;
+	remove(serial_name.c_str());
+
+	const CompressionSettings settings[4] = { CompressionSettings(6, false, 100000),
+		CompressionSettings(6, true, 100000), CompressionSettings(1, true, 100000),
+		CompressionSettings(6, true, 16384) };
+	const string parallel_name = dir + "/compression_parallel.h5";
+	for (size_t k = 0; k < 4; ++k)
+	{
+		start = wall_time();
+		write_snapshot_to_hdf5(cells, edges, 0, 0, parallel_name, SnapshotCompression(settings[k]));
+		elapsed = wall_time() - start;
+		same = same_data(read_hdf5_snapshot(parallel_name), cells, edges);
+		all_same = all_same && same;
+		cout << "direct chunks" << setw(11) << settings[k].level << setw(8) << (settings[k].shuffle ? "yes" : "no") <<
+			setw(7) << settings[k].chunk << setw(10) << elapsed << setw(13) << file_size(parallel_name) <<
+			setw(11) << (same ? "yes" : "NO") << endl;
+		remove(parallel_name.c_str());
+	}
+	return all_same ? 0 : 1;
+}
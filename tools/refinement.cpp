@@ -0,0 +1,99 @@
+// Measures what splitting and merging cells buys on a Sod shock tube. Runs a fine uniform mesh as the reference,
+// then uniform meshes of 1, 2 and 4 times the coarse cells and the coarse mesh with refinement. Prints their cell
+// counts, their cost in cell updates, their L1 density error against the reference and how well they conserve
+// mass and energy, and compares the refined mesh to the cheapest uniform mesh that is at least as accurate.
+// Usage: refinement [coarse cells] [reference cells] [end time] [max jump] [min jump] [max mass ratio] [min width]
+#include "hdsim.hpp"
+#include "tool_util.hpp"
+#include <iostream>
+#include <iomanip>
+#include <cstdlib>
+#include <cmath>
+#include <algorithm>
+
+namespace
+{
+	double total(vector<double> const& values)
+	{
+		double res = 0;
+		for (size_t i = 0; i < values.size(); ++i)
+			res += values[i];
+		return res;
+	}
+
+	double l1_error(hdsim const& sim, hdsim const& reference)
+	{
+		vector<double> const& edges = sim.GetEdges();
+		vector<double> const& ref_edges = reference.GetEdges();
+		double res = 0;
+		for (size_t i = 0; i + 1 < edges.size(); ++i)
+		{
+			const double x = 0.5*(edges[i] + edges[i + 1]);
+			size_t j = static_cast<size_t>(upper_bound(ref_edges.begin(), ref_edges.end(), x) - ref_edges.begin());
+			j = min(max(j, static_cast<size_t>(1)), ref_edges.size() - 1) - 1;
+			res += fabs(sim.GetCellArrays().density[i] - reference.GetCellArrays().density[j])*(edges[i + 1] - edges[i]);
+		}
+		return res;
+	}
+}
+
+int main(int argc, char **argv)
+{
+	const size_t N = argc > 1 ? static_cast<size_t>(atol(argv[1])) : 100;
+	const size_t Nref = argc > 2 ? static_cast<size_t>(atol(argv[2])) : 2000;
+	const double tend = argc > 3 ? atof(argv[3]) : 0.2;
+	StandardRefinement criteria(argc > 4 ? atof(argv[4]) : 0.05, argc > 5 ? atof(argv[5]) : 0.005,
+		argc > 6 ? atof(argv[6]) : 2, argc > 7 ? atof(argv[7]) : 0.25 / static_cast<double>(N));
+
+	const double gamma = 5.0 / 3.0;
+	IdealGas eos(gamma);
+	ExactRS rs(gamma);
+	RigidWall boundary;
+	MinMod interp(boundary);
+	ZeroForce force;
+	const vector<double> ref_edges = uniform_edges(Nref);
+	hdsim reference(0.3, sod_cells(ref_edges, eos), ref_edges, interp, eos, rs, force);
+	while (reference.GetTime() < tend)
+		reference.TimeAdvance2();
+
+	cout << "mesh        cells  mean cells  cell updates  L1 error  mass error  energy error" << endl;
+	// The uniform meshes, then the coarsest with refinement
+	const size_t runs = 4;
+	double errors[runs];
+	size_t updates[runs];
+	for (size_t run = 0; run < runs; ++run)
+	{
+		const bool refine = run == runs - 1;
+		const vector<double> edges = uniform_edges(refine ? N : N << run);
+		hdsim sim(0.3, sod_cells(edges, eos), edges, interp, eos, rs, force);
+		if (refine)
+			sim.SetRefinement(&criteria);
+		const double mass = total(sim.GetExtensives().mass);
+		const double energy = total(sim.GetExtensives().energy);
+		double cells = 0;
+		while (sim.GetTime() < tend)
+		{
+			sim.TimeAdvance2();
+			cells += static_cast<double>(sim.GetCellArrays().size());
+		}
+		errors[run] = l1_error(sim, reference);
+		updates[run] = sim.GetCellUpdates();
+		cout << (refine ? "refined " : "uniform ") << setw(9) << sim.GetCellArrays().size() << setw(12) <<
+			setprecision(4) << cells / static_cast<double>(sim.GetCycle()) << setw(14) << updates[run] <<
+			setw(10) << errors[run] << setw(12) << (total(sim.GetExtensives().mass) - mass) / mass <<
+			setw(14) << (total(sim.GetExtensives().energy) - energy) / energy << endl;
+	}
+	cout << "reference " << setw(7) << Nref << setw(26) << reference.GetCellUpdates() << endl;
+	for (size_t run = 0; run + 1 < runs; ++run)
+		if (errors[run] <= errors[runs - 1])
+		{
+			cout << "the uniform mesh of " << (N << run) << " cells is as accurate and costs " <<
+				static_cast<double>(updates[run]) / static_cast<double>(updates[runs - 1]) <<
+				" times the refined mesh" << endl;
+			return 0;
+		}
+	cout << "the refined mesh is more accurate than every uniform mesh, the finest costs " <<
+		static_cast<double>(updates[runs - 2]) / static_cast<double>(updates[runs - 1]) << " times as much" <<
+		endl;
+	return 0;
+}
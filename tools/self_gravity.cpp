@@ -0,0 +1,104 @@
+// Checks the enclosed mass prefix sum of SelfGravity and times it. A uniform sphere must give -4pi/3 x to round
+// off, a centrally condensed star must give the same accelerations bit for bit on one thread, on all threads and
+// split over all MPI processes.
+// Usage: [mpirun -np <processes>] self_gravity [cells] [repeats]
+#define _USE_MATH_DEFINES
+#include "SelfGravity.hpp"
+#include "tool_util.hpp"
+#include <iostream>
+#include <cstdlib>
+#include <cmath>
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+namespace
+{
+	void set_threads(int threads)
+	{
+#ifdef _OPENMP
+		omp_set_num_threads(threads);
+#else
+		(void)threads;
+#endif
+	}
+
+	int max_threads(void)
+	{
+#ifdef _OPENMP
+		return omp_get_max_threads();
+#else
+		return 1;
+#endif
+	}
+
+	ExtensiveArrays star(vector<double> const& edges, bool uniform)
+	{
+		ExtensiveArrays res;
+		res.resize(edges.size() - 1);
+		for (size_t i = 0; i < res.size(); ++i)
+		{
+			const double x = 0.5*(edges[i] + edges[i + 1]);
+			const double d = uniform ? 1 : 1 / (1 + 100 * x*x);
+			res.mass[i] = d*(edges[i + 1] - edges[i]);
+		}
+		return res;
+	}
+}
+
+int main(int argc, char **argv)
+{
+#ifdef HDSIM_MPI
+	MPI_Init(&argc, &argv);
+#endif
+	const size_t N = argc > 1 ? static_cast<size_t>(atol(argv[1])) : 1000000;
+	const size_t repeats = argc > 2 ? static_cast<size_t>(atol(argv[2])) : 20;
+	const vector<double> edges = uniform_edges(N);
+	const int threads = max_threads();
+
+	// The whole mesh on one thread is the reference
+	set_threads(1);
+	SelfGravity whole;
+	whole.Prepare(edges, star(edges, true), 0);
+	double uniform_error = 0;
+	for (size_t i = 0; i < N; ++i)
+	{
+		const double x = 0.5*(edges[i] + edges[i + 1]);
+		uniform_error = max(uniform_error, fabs(whole.GetAcceleration()[i] / (-4 * M_PI*x / 3) - 1));
+	}
+	const ExtensiveArrays extensives = star(edges, false);
+	whole.Prepare(edges, extensives, 0);
+	const vector<double> reference = whole.GetAcceleration();
+
+	set_threads(threads);
+	whole.Prepare(edges, extensives, 0);
+	const bool same_threads = whole.GetAcceleration() == reference;
+
+	DomainDecomposition domain(N);
+	const vector<double> local_edges = domain.LocalEdges(edges);
+	ExtensiveArrays local;
+	local.mass = domain.LocalCells(extensives.mass);
+	local.momentum.resize(local.mass.size());
+	local.energy.resize(local.mass.size());
+	SelfGravity split;
+	split.SetDomain(domain);
+	split.Prepare(local_edges, local, 0);
+	const bool same_local = split.GetAcceleration() == domain.LocalCells(reference);
+	const bool same_processes = domain.Sum(same_local ? 0 : 1) == 0;
+
+	const double start = wall_time();
+	for (size_t r = 0; r < repeats; ++r)
+		split.Prepare(local_edges, local, 0);
+	const double elapsed = wall_time() - start;
+
+	if (domain.IsFirst())
+		cout << "cells " << N << " processes " << domain.GetSize() << " threads " << threads <<
+			"\nmax relative error of a uniform sphere " << uniform_error <<
+			"\nidentical on all threads " << (same_threads ? "yes" : "NO") <<
+			"\nidentical on all processes " << (same_processes ? "yes" : "NO") <<
+			"\nnanoseconds per cell " << 1e9*elapsed / static_cast<double>(repeats*local.size()) << endl;
+#ifdef HDSIM_MPI
+	MPI_Finalize();
+#endif
+	return (same_threads && same_processes) ? 0 : 1;
+}
@@ -0,0 +1,121 @@
+// Writes a set of snapshots deflated and stored contiguously, then times reading the central density and a radius
+// range of every file with the old whole snapshot reader against SnapshotReader, and checks that they agree.
+// Usage: snapshot_reader [cells] [files] [output directory]
+#include "SnapshotReader.hpp"
+#include "hdf_util.hpp"
+#include "tool_util.hpp"
+#include <iostream>
+#include <sstream>
+#include <cstdlib>
+#include <cstdio>
+#include <cmath>
+
+namespace
+{
+	string snapshot_name(string const& dir, string const& prefix, size_t index)
+	{
+		ostringstream res;
+		res << dir << "/" << prefix << index << ".h5";
+		return res.str();
+	}
+
+	// The snapshot reader before SnapshotReader, every dataset into a vector then copied cell by cell
+	Snapshot read_whole(string const& fname)
+	{
+		H5::H5File file(fname, H5F_ACC_RDONLY);
+		H5::Group geometry = file.openGroup("geometry");
+		H5::Group hydrodynamic = file.openGroup("hydrodynamic");
+		char const* captions[4] = { "edges", "density", "pressure", "velocity" };
+		vector<double> fields[4];
+		for (size_t k = 0; k < 4; ++k)
+		{
+			DataSet dataset = (k == 0 ? geometry : hydrodynamic).openDataSet(captions[k]);
+			hsize_t dims[1];
+			dataset.getSpace().getSimpleExtentDims(dims, NULL);
+			fields[k].resize(static_cast<size_t>(dims[0]));
+			dataset.read(&fields[k][0], PredType::NATIVE_DOUBLE);
+		}
+		Snapshot res;
+		res.edges = fields[0];
+		res.cells.resize(fields[1].size());
+		for (size_t i = 0; i < res.cells.size(); ++i)
+		{
+			res.cells.at(i).density = fields[1].at(i);
+			res.cells.at(i).pressure = fields[2].at(i);
+			res.cells.at(i).velocity = fields[3].at(i);
+		}
+		return res;
+	}
+}
+
+int main(int argc, char **argv)
+{
+	const size_t N = argc > 1 ? static_cast<size_t>(atol(argv[1])) : 1000000;
+	const size_t files = argc > 2 ? static_cast<size_t>(atol(argv[2])) : 20;
+	const string dir = argc > 3 ? argv[3] : ".";
+
+	vector<double> edges(N + 1);
+	for (size_t i = 0; i <= N; ++i)
+		edges[i] = pow(static_cast<double>(i) / static_cast<double>(N), 1.5);
+	PrimitiveArrays cells;
+	cells.resize(N);
+	for (size_t i = 0; i < N; ++i)
+	{
+		const double x = 0.5*(edges[i] + edges[i + 1]);
+		cells.density[i] = exp(-3 * x);
+		cells.pressure[i] = pow(cells.density[i], 5.0 / 3.0);
+		cells.velocity[i] = -0.1*x;
+	}
+	// The profile is taken between these radii
+	const double inner = 0.5;
+	const double outer = 0.52;
+
+	char const* prefixes[2] = { "deflated_", "contiguous_" };
+	const SnapshotCompression compression[2] = { SnapshotCompression(), SnapshotCompression(CompressionSettings(0)) };
+	bool all_same = true;
+	cout << "cells " << N << " files " << files << endl;
+	for (size_t k = 0; k < 2; ++k)
+	{
+		for (size_t f = 0; f < files; ++f)
+			write_snapshot_to_hdf5(cells, edges, static_cast<double>(f), f, snapshot_name(dir, prefixes[k], f),
+				compression[k]);
+
+		double start = wall_time();
+		double whole_sum = 0;
+		for (size_t f = 0; f < files; ++f)
+		{
+			const Snapshot snapshot = read_whole(snapshot_name(dir, prefixes[k], f));
+			whole_sum += snapshot.cells[0].density;
+			for (size_t i = 0; i < snapshot.cells.size(); ++i)
+				if (snapshot.edges[i + 1] > inner && snapshot.edges[i] < outer)
+					whole_sum += snapshot.cells[i].pressure;
+		}
+		const double whole_time = wall_time() - start;
+
+		start = wall_time();
+		double lazy_sum = 0;
+		bool mapped = true;
+		for (size_t f = 0; f < files; ++f)
+		{
+			const SnapshotReader reader(snapshot_name(dir, prefixes[k], f));
+			const FieldView<double> central = reader.GetDensity(0, 1);
+			lazy_sum += central[0];
+			size_t begin = 0;
+			size_t end = 0;
+			reader.FindCells(inner, outer, begin, end);
+			const FieldView<double> pressure = reader.GetPressure(begin, end);
+			for (size_t i = 0; i < pressure.size(); ++i)
+				lazy_sum += pressure[i];
+			mapped = mapped && central.IsMapped() && pressure.IsMapped();
+		}
+		const double lazy_time = wall_time() - start;
+
+		for (size_t f = 0; f < files; ++f)
+			remove(snapshot_name(dir, prefixes[k], f).c_str());
+		const bool same = lazy_sum == whole_sum;
+		all_same = all_same && same;
+		cout << prefixes[k] << " seconds reading whole snapshots " << whole_time << " reading the fields " <<
+			lazy_time << " mapped " << (mapped ? "yes" : "no") << " same results " << (same ? "yes" : "NO") << endl;
+	}
+	return all_same ? 0 : 1;
+}
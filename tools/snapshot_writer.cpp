@@ -0,0 +1,84 @@
+// Times a Sod shock tube that writes a snapshot every few cycles, once with the synchronous writer and once with
+// SnapshotWriter, and checks that both wrote the same files.
+// Usage: snapshot_writer [cells] [cycles] [cycles per snapshot] [output directory]
+#include "SnapshotWriter.hpp"
+#include "hdf_util.hpp"
+#include "tool_util.hpp"
+#include <iostream>
+#include <sstream>
+#include <cstdlib>
+
+namespace
+{
+	string snapshot_name(string const& dir, string const& prefix, size_t index)
+	{
+		ostringstream res;
+		res << dir << "/" << prefix << index << ".h5";
+		return res.str();
+	}
+
+	bool same_snapshot(string const& a, string const& b)
+	{
+		const Snapshot first = read_hdf5_snapshot(a);
+		const Snapshot second = read_hdf5_snapshot(b);
+		bool res = first.edges == second.edges && first.time == second.time && first.cycle == second.cycle &&
+			first.cells.size() == second.cells.size();
+		for (size_t i = 0; res && i < first.cells.size(); ++i)
+			res = first.cells[i].density == second.cells[i].density &&
+				first.cells[i].pressure == second.cells[i].pressure &&
+				first.cells[i].velocity == second.cells[i].velocity;
+		return res;
+	}
+}
+
+int main(int argc, char **argv)
+{
+	const size_t N = argc > 1 ? static_cast<size_t>(atol(argv[1])) : 1000000;
+	const size_t cycles = argc > 2 ? static_cast<size_t>(atol(argv[2])) : 40;
+	const size_t every = argc > 3 ? static_cast<size_t>(atol(argv[3])) : 4;
+	const string dir = argc > 4 ? argv[4] : ".";
+
+	const double gamma = 5.0 / 3.0;
+	IdealGas eos(gamma);
+	ExactRS rs(gamma);
+	RigidWall boundary;
+	MinMod interp(boundary);
+	ZeroForce force;
+	const vector<double> edges = uniform_edges(N);
+	const vector<Primitive> cells = sod_cells(edges, eos);
+
+	char const* prefixes[2] = { "sync_", "async_" };
+	double elapsed[2] = { 0, 0 };
+	size_t snapshots = 0;
+	size_t stalls = 0;
+	for (size_t k = 0; k < 2; ++k)
+	{
+		hdsim sim(0.3, cells, edges, interp, eos, rs, force);
+		SnapshotWriter writer;
+		snapshots = 0;
+		const double start = wall_time();
+		for (size_t c = 0; c < cycles; ++c)
+		{
+			if (c % every == 0)
+			{
+				if (k == 0)
+					write_snapshot_to_hdf5(sim, snapshot_name(dir, prefixes[k], snapshots));
+				else
+					writer.Write(sim, snapshot_name(dir, prefixes[k], snapshots));
+				++snapshots;
+			}
+			sim.TimeAdvance2();
+		}
+		writer.Flush();
+		elapsed[k] = wall_time() - start;
+		stalls = writer.GetStalls();
+	}
+
+	bool same = true;
+	for (size_t i = 0; i < snapshots; ++i)
+		same = same && same_snapshot(snapshot_name(dir, prefixes[0], i), snapshot_name(dir, prefixes[1], i));
+	cout << "cells " << N << " cycles " << cycles << " snapshots " << snapshots << "\nsynchronous seconds " <<
+		elapsed[0] << "\nasynchronous seconds " << elapsed[1] << " stalls " << stalls << "\nidentical files " <<
+		(same ? "yes" : "NO") << endl;
+	return same ? 0 : 1;
+}
@@ -0,0 +1,84 @@
+// Runs a Sod shock tube with the ideal gas and with a table of it, and times the batched and single cell calls
+// of both equations of state. The ideal gas is a power law, so the table should reproduce it to round off.
+// Usage: tabulated_eos [cells] [end time] [table points]
+#include "hdsim.hpp"
+#include "TabulatedEOS.hpp"
+#include "tool_util.hpp"
+#include <iostream>
+#include <iomanip>
+#include <cstdlib>
+#include <cmath>
+#include <ctime>
+
+namespace
+{
+	// Entropies of n cells per call, repeated until a million cells were converted, in conversions per second
+	double batch_rate(EquationOfState const& eos, vector<double> const& d, vector<double> const& p,
+		vector<double> &s, bool batched)
+	{
+		const size_t n = d.size();
+		const size_t repeats = 1000000 / n + 1;
+		const clock_t start = clock();
+		for (size_t r = 0; r < repeats; ++r)
+		{
+			if (batched)
+				eos.dp2s(&d[0], &p[0], &s[0], n);
+			else
+				for (size_t i = 0; i < n; ++i)
+					s[i] = eos.dp2s(d[i], p[i]);
+		}
+		const double elapsed = static_cast<double>(clock() - start) / CLOCKS_PER_SEC;
+		return static_cast<double>(n*repeats) / elapsed;
+	}
+}
+
+int main(int argc, char **argv)
+{
+	const size_t N = argc > 1 ? static_cast<size_t>(atol(argv[1])) : 1000;
+	const double tend = argc > 2 ? atof(argv[2]) : 0.2;
+	const size_t points = argc > 3 ? static_cast<size_t>(atol(argv[3])) : 128;
+
+	const double gamma = 1.4;
+	IdealGas ideal(gamma);
+	const TabulatedEOS table(ideal, 1e-3, 10, 1e-3, 10, points);
+	ExactRS rs(gamma);
+	RigidWall boundary;
+	MinMod interp(boundary);
+	ZeroForce force;
+	const vector<double> edges = uniform_edges(N);
+
+	cout << "eos        cycles  seconds  L1 density difference" << endl;
+	EquationOfState const* eos[2] = { &ideal, &table };
+	char const* names[2] = { "ideal", "tabulated" };
+	PrimitiveArrays reference;
+	for (size_t k = 0; k < 2; ++k)
+	{
+		hdsim sim(0.3, sod_cells(edges, *eos[k]), edges, interp, *eos[k], rs, force);
+		const clock_t start = clock();
+		while (sim.GetTime() < tend)
+			sim.TimeAdvance2();
+		const double elapsed = static_cast<double>(clock() - start) / CLOCKS_PER_SEC;
+		if (k == 0)
+			reference = sim.GetCellArrays();
+		double difference = 0;
+		for (size_t i = 0; i < N; ++i)
+			difference += fabs(sim.GetCellArrays().density[i] - reference.density[i]) *
+				(sim.GetEdges()[i + 1] - sim.GetEdges()[i]);
+		cout << setw(9) << left << names[k] << right << setw(8) << sim.GetCycle() << setw(9) << setprecision(3) <<
+			elapsed << setw(23) << difference << endl;
+	}
+
+	// Cells of a smooth profile, as in a sweep through a star
+	vector<double> d(256), p(256), s(256);
+	for (size_t i = 0; i < d.size(); ++i)
+	{
+		const double x = static_cast<double>(i) / static_cast<double>(d.size());
+		d[i] = 5 * exp(-5 * x);
+		p[i] = 5 * exp(-7 * x);
+	}
+	cout << "eos        single cell calls/s  batched calls/s" << endl;
+	for (size_t k = 0; k < 2; ++k)
+		cout << setw(9) << left << names[k] << right << setw(21) << batch_rate(*eos[k], d, p, s, false) <<
+			setw(17) << batch_rate(*eos[k], d, p, s, true) << endl;
+	return 0;
+}
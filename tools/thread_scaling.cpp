@@ -0,0 +1,76 @@
+// Strong scaling benchmark for the threaded TimeAdvance2, runs a Sod shock tube with an increasing number of
+// threads and checks that every run reproduces the single thread result bit for bit.
+// Usage: thread_scaling [cells] [cycles] [max threads] [fused]
+#include "hdsim.hpp"
+#include "tool_util.hpp"
+#include <iostream>
+#include <iomanip>
+#include <cstdlib>
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+namespace
+{
+	size_t default_threads(void)
+	{
+#ifdef _OPENMP
+		return static_cast<size_t>(omp_get_max_threads());
+#else
+		return 1;
+#endif
+	}
+}
+
+int main(int argc, char **argv)
+{
+	const size_t N = argc > 1 ? static_cast<size_t>(atol(argv[1])) : 1000000;
+	const size_t cycles = argc > 2 ? static_cast<size_t>(atol(argv[2])) : 20;
+	const size_t max_threads = argc > 3 ? static_cast<size_t>(atol(argv[3])) : default_threads();
+	const bool fused = argc > 4 && atoi(argv[4]) != 0;
+
+	const double gamma = 5.0 / 3.0;
+	IdealGas eos(gamma);
+	ExactRS rs(gamma);
+	RigidWall boundary;
+	MinMod interp(boundary);
+	ZeroForce force;
+	const vector<double> edges = uniform_edges(N);
+	const vector<Primitive> cells = sod_cells(edges, eos);
+
+	PrimitiveArrays serial_cells;
+	vector<double> serial_edges;
+	double serial_time = 0;
+	cout << "cells " << N << " cycles " << cycles << (fused ? " fused" : "") << endl;
+	cout << "threads  seconds  Mcell-updates/s  speedup  efficiency  identical" << endl;
+	size_t threads = 1;
+	while (threads <= max_threads)
+	{
+		hdsim sim(0.3, cells, edges, interp, eos, rs, force);
+		sim.SetFusedStepping(fused);
+		sim.SetThreads(threads);
+		// One untimed cycle so that all the buffers are allocated
+		sim.TimeAdvance2();
+		const double start = wall_time();
+		for (size_t c = 0; c < cycles; ++c)
+			sim.TimeAdvance2();
+		const double elapsed = wall_time() - start;
+		if (threads == 1)
+		{
+			serial_time = elapsed;
+			serial_cells = sim.GetCellArrays();
+			serial_edges = sim.GetEdges();
+		}
+		const double rate = static_cast<double>(N*cycles) / elapsed / 1e6;
+		const double speedup = serial_time / elapsed;
+		cout << setw(7) << threads << setw(9) << setprecision(3) << elapsed << setw(17) << rate << setw(9) <<
+			speedup << setw(12) << speedup / static_cast<double>(threads) << setw(11) <<
+			(same_state(sim.GetCellArrays(), sim.GetEdges(), serial_cells, serial_edges) ? "yes" : "NO") << endl;
+		// Powers of two, then the largest thread count
+		if (threads < max_threads && 2 * threads > max_threads)
+			threads = max_threads;
+		else
+			threads *= 2;
+	}
+	return 0;
+}
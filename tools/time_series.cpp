@@ -0,0 +1,85 @@
+// Writes the snapshots of a Sod shock tube both as one file each and appended to a single time series, times the
+// two and checks that every snapshot read back from the time series matches its own file. Also times reading the
+// last snapshot, which must not depend on the number before it.
+// Usage: time_series [cells] [snapshots] [cycles per snapshot] [output directory]
+#include "TimeSeriesWriter.hpp"
+#include "hdf_util.hpp"
+#include "tool_util.hpp"
+#include <iostream>
+#include <sstream>
+#include <cstdlib>
+
+namespace
+{
+	string snapshot_name(string const& dir, size_t index)
+	{
+		ostringstream res;
+		res << dir << "/tide_" << index << ".h5";
+		return res.str();
+	}
+
+	bool same_snapshot(Snapshot const& first, Snapshot const& second)
+	{
+		bool res = first.edges == second.edges && first.time == second.time && first.cycle == second.cycle &&
+			first.cells.size() == second.cells.size();
+		for (size_t i = 0; res && i < first.cells.size(); ++i)
+			res = first.cells[i].density == second.cells[i].density &&
+				first.cells[i].pressure == second.cells[i].pressure &&
+				first.cells[i].velocity == second.cells[i].velocity;
+		return res;
+	}
+}
+
+int main(int argc, char **argv)
+{
+	const size_t N = argc > 1 ? static_cast<size_t>(atol(argv[1])) : 1000;
+	const size_t snapshots = argc > 2 ? static_cast<size_t>(atol(argv[2])) : 1000;
+	const size_t every = argc > 3 ? static_cast<size_t>(atol(argv[3])) : 1;
+	const string dir = argc > 4 ? argv[4] : ".";
+
+	const double gamma = 5.0 / 3.0;
+	IdealGas eos(gamma);
+	ExactRS rs(gamma);
+	RigidWall boundary;
+	MinMod interp(boundary);
+	ZeroForce force;
+	const vector<double> edges = uniform_edges(N);
+	const vector<Primitive> cells = sod_cells(edges, eos);
+
+	hdsim sim(0.3, cells, edges, interp, eos, rs, force);
+	const string series_name = dir + "/tide.h5";
+	double file_time = 0;
+	double series_time = 0;
+	{
+		TimeSeriesWriter series(series_name);
+		for (size_t k = 0; k < snapshots; ++k)
+		{
+			double start = wall_time();
+			write_snapshot_to_hdf5(sim, snapshot_name(dir, k));
+			file_time += wall_time() - start;
+			start = wall_time();
+			series.Append(sim.GetCellArrays(), sim.GetEdges(), sim.GetTime(), sim.GetCycle());
+			series_time += wall_time() - start;
+			for (size_t c = 0; c < every; ++c)
+				sim.TimeAdvance2();
+		}
+		const double start = wall_time();
+		series.Flush();
+		series_time += wall_time() - start;
+	}
+
+	bool same = count_time_series_snapshots(series_name) == snapshots;
+	for (size_t k = 0; same && k < snapshots; ++k)
+		same = same_snapshot(read_time_series_snapshot(series_name, k), read_hdf5_snapshot(snapshot_name(dir, k)));
+	double start = wall_time();
+	read_time_series_snapshot(series_name, 0);
+	const double first_read = wall_time() - start;
+	start = wall_time();
+	read_time_series_snapshot(series_name, snapshots - 1);
+	const double last_read = wall_time() - start;
+
+	cout << "cells " << N << " snapshots " << snapshots << "\nseconds writing one file each " << file_time <<
+		"\nseconds appending to a time series " << series_time << "\nseconds reading the first snapshot " <<
+		first_read << " the last " << last_read << "\nidentical snapshots " << (same ? "yes" : "NO") << endl;
+	return same ? 0 : 1;
+}
@@ -0,0 +1,49 @@
+#ifndef TOOL_UTIL_HPP
+#define TOOL_UTIL_HPP 1
+
+#include "StateArrays.hpp"
+#include "EquationOfState.hpp"
+#include "wall_time.hpp"
+#include <vector>
+
+using namespace std;
+
+//! \brief Edges of N equal cells on [0,1]
+inline vector<double> uniform_edges(size_t N)
+{
+	vector<double> res(N + 1);
+	for (size_t i = 0; i <= N; ++i)
+		res[i] = static_cast<double>(i) / static_cast<double>(N);
+	return res;
+}
+
+//! \brief A shock tube at rest, the cells whose centre is left of 0.5 have the left density and pressure
+inline vector<Primitive> shock_tube_cells(vector<double> const& edges, EquationOfState const& eos,
+	double left_density, double left_pressure, double right_density, double right_pressure)
+{
+	vector<Primitive> res(edges.size() - 1);
+	for (size_t i = 0; i < res.size(); ++i)
+	{
+		const bool inside = edges[i] + edges[i + 1] < 1;
+		const double d = inside ? left_density : right_density;
+		const double p = inside ? left_pressure : right_pressure;
+		res[i] = Primitive(d, p, 0, eos.dp2s(d, p));
+	}
+	return res;
+}
+
+//! \brief Sod's shock tube
+inline vector<Primitive> sod_cells(vector<double> const& edges, EquationOfState const& eos)
+{
+	return shock_tube_cells(edges, eos, 1, 1, 0.125, 0.1);
+}
+
+//! \brief Whether two states are bitwise identical
+inline bool same_state(PrimitiveArrays const& a, vector<double> const& a_edges, PrimitiveArrays const& b,
+	vector<double> const& b_edges)
+{
+	return a.density == b.density && a.pressure == b.pressure && a.velocity == b.velocity &&
+		a.entropy == b.entropy && a_edges == b_edges;
+}
+
+#endif //TOOL_UTIL_HPP
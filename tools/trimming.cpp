@@ -0,0 +1,119 @@
+// Checks that trimming conserves and keeps the engines consistent. A blast in the middle of a tube of gas at rest,
+// with a light layer at the outer end in pressure balance, is run while trimming removes the outer cells a few at a
+// time by radius, then the rest of the light layer by density, then more cells by radius and finally all but four.
+// The light layer gets lighter outwards, so the outermost cells limit the time step until they are removed. The
+// waves do not reach the removed cells or the walls, so the walls push equally and the mass, momentum and energy on
+// the mesh plus the outflow must stay what they were. The run is repeated with the fused engine, the Riemann cache
+// and both, whose caches and next time step have to be reset by each trim. All must give the same results as the
+// default.
+// Usage: trimming [cells]
+#include "hdsim.hpp"
+#include "tool_util.hpp"
+#include <iostream>
+#include <cstdlib>
+#include <cmath>
+
+namespace
+{
+	double total(vector<double> const& values)
+	{
+		double res = 0;
+		for (size_t i = 0; i < values.size(); ++i)
+			res += values[i];
+		return res;
+	}
+
+	vector<Primitive> blast_cells(vector<double> const& edges, EquationOfState const& eos)
+	{
+		vector<Primitive> res(edges.size() - 1);
+		for (size_t i = 0; i < res.size(); ++i)
+		{
+			const double x = 0.5*(edges[i] + edges[i + 1]);
+			const double d = x > 0.9 ? 0.1*(1 - x) + 0.001 : 1;
+			const double p = (x > 0.45 && x < 0.55) ? 10 : 1;
+			res[i] = Primitive(d, p, 0, eos.dp2s(d, p));
+		}
+		return res;
+	}
+}
+
+int main(int argc, char **argv)
+{
+	const size_t N = argc > 1 ? static_cast<size_t>(atol(argv[1])) : 400;
+
+	const double gamma = 5.0 / 3.0;
+	IdealGas eos(gamma);
+	ExactRS rs(gamma);
+	RigidWall boundary;
+	MinMod interp(boundary);
+	ZeroForce force;
+	const vector<double> edges = uniform_edges(N);
+	const vector<Primitive> cells = blast_cells(edges, eos);
+	// Mass times sound speed, the scale of the momentum
+	double momentum_scale = 0;
+	for (size_t i = 0; i < N; ++i)
+		momentum_scale += cells[i].density*(edges[i + 1] - edges[i])*sqrt(gamma*cells[i].pressure /
+			cells[i].density);
+	const double tolerance = 1e-13;
+
+	char const* modes[4] = { "default", "fused", "cache", "fused cache" };
+	// Results of the default run
+	PrimitiveArrays reference_cells;
+	vector<double> reference_edges;
+	double reference_time = 0;
+	Extensive reference_outflow;
+	bool good = true;
+	for (size_t mode = 0; mode < 4; ++mode)
+	{
+		hdsim sim(0.3, cells, edges, interp, eos, rs, force);
+		sim.SetFusedStepping(mode == 1 || mode == 3);
+		// Only identical states reuse a solution, so the cache does not change the results
+		if (mode >= 2)
+			sim.SetRiemannCache(1e-300);
+		const double mass = total(sim.GetExtensives().mass);
+		const double energy = total(sim.GetExtensives().energy);
+		double worst = 0;
+		bool shrinks = true;
+		// Radii in the light layer, the rest of it by density, radii in the dense gas, all but four
+		const double radii[11] = { 0.99, 0.98, 0.97, 0.96, 0.95, 0.94, 0.93, 2, 0.88, 0.86, 0 };
+		for (size_t stage = 0; stage < 11; ++stage)
+		{
+			sim.SetTrimming(radii[stage], stage == 7 ? 0.1 : 0);
+			const size_t before = sim.GetCellArrays().size();
+			for (size_t c = 0; c < 10; ++c)
+			{
+				sim.TimeAdvance2();
+				Extensive const& outflow = sim.GetOutflow();
+				ExtensiveArrays const& extensives = sim.GetExtensives();
+				worst = max(worst, fabs(total(extensives.mass) + outflow.mass - mass) / mass);
+				worst = max(worst, fabs(total(extensives.momentum) + outflow.momentum) / momentum_scale);
+				worst = max(worst, fabs(total(extensives.energy) + outflow.energy - energy) / energy);
+			}
+			const size_t after = sim.GetCellArrays().size();
+			shrinks = shrinks && after < before && N - after == sim.GetTrimmedCells() &&
+				sim.GetEdges().size() == after + 1;
+		}
+		const size_t left = sim.GetCellArrays().size();
+		// The cells left are still at rest, the time and the outflow tell whether the steps were the same
+		Extensive const& outflow = sim.GetOutflow();
+		bool same = true;
+		if (mode == 0)
+		{
+			reference_cells = sim.GetCellArrays();
+			reference_edges = sim.GetEdges();
+			reference_time = sim.GetTime();
+			reference_outflow = outflow;
+		}
+		else
+			same = same_state(sim.GetCellArrays(), sim.GetEdges(), reference_cells, reference_edges) &&
+				sim.GetTime() == reference_time && outflow.mass == reference_outflow.mass &&
+				outflow.momentum == reference_outflow.momentum && outflow.energy == reference_outflow.energy;
+		const bool mode_good = worst < tolerance && shrinks && left == 4 && same;
+		good = good && mode_good;
+		cout << modes[mode] << ": cells left " << left << " trimmed " << sim.GetTrimmedCells() <<
+			" largest relative change of mesh plus outflow " << worst << " shrank every stage " <<
+			(shrinks ? "yes" : "NO") << " same as default " << (same ? "yes" : "NO") << endl;
+	}
+	cout << (good ? "conserved" : "FAILED") << endl;
+	return good ? 0 : 1;
+}
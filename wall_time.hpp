@@ -0,0 +1,19 @@
+#ifndef WALL_TIME_HPP
+#define WALL_TIME_HPP 1
+
+#include <ctime>
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+//! \brief Wall clock seconds, or processor seconds without OpenMP
+inline double wall_time(void)
+{
+#ifdef _OPENMP
+	return omp_get_wtime();
+#else
+	return static_cast<double>(clock()) / CLOCKS_PER_SEC;
+#endif
+}
+
+#endif //WALL_TIME_HPP